@@ -280,7 +280,7 @@ int NCPkgFilterClassification::itemIndex( YItem * item ) const
 NCursesEvent NCPkgFilterClassification::wHandleInput( wint_t ch )
 {
     NCursesEvent ret = NCursesEvent::none;
-    handleInput( ch );
+    int oldItem = getCurrentItem();
 
     switch ( ch )
     {
@@ -290,13 +290,22 @@ NCursesEvent NCPkgFilterClassification::wHandleInput( wint_t ch )
 	case KEY_PPAGE:
 	case KEY_END:
 	case KEY_HOME:
+            handleInput( ch );
             ret = NCursesEvent::handled;
             showPackages();
             showDescription();
             break;
 
 	default:
+            // this calls handleInput() (only once!)
             ret = NCSelectionBox::wHandleInput( ch );
+
+            // type-ahead search
+            if ( getCurrentItem() != oldItem )
+            {
+                showPackages();
+                showDescription();
+            }
             break;
     }
 
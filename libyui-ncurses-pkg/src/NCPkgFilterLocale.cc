@@ -66,6 +66,7 @@ NCPkgLocaleTable::NCPkgLocaleTable( YWidget *parent, YTableHeader *tableHeader,
     :NCTable( parent, tableHeader )
     , packager(pkg)
 {
+   setSearchColumn( 1 );	// the language code, not the status
    fillHeader();
    fillLocaleList();
 }
@@ -224,7 +225,7 @@ void NCPkgLocaleTable::cycleStatus()
 NCursesEvent NCPkgLocaleTable::wHandleInput( wint_t ch )
 {
     NCursesEvent ret = NCursesEvent::none;
-    handleInput( ch );
+    int oldItem = getCurrentItem();
 
     switch ( ch )
     {
@@ -234,19 +235,26 @@ NCursesEvent NCPkgLocaleTable::wHandleInput( wint_t ch )
 	case KEY_PPAGE:
 	case KEY_END:
 	case KEY_HOME:
+	    handleInput( ch );
 	    ret = NCursesEvent::handled;
             showLocalePackages();
 	    break;
 
 	case KEY_SPACE:
 	case KEY_RETURN:
+	    handleInput( ch );
 	    ret = NCursesEvent::handled;
 	    cycleStatus();
 	    showLocalePackages();
 	    break;
 
 	default:
+	    // this calls handleInput() (only once!)
 	    ret = NCTable::wHandleInput( ch );
+
+	    // type-ahead search
+	    if ( getCurrentItem() != oldItem )
+		showLocalePackages();
 	    break;
     }
 
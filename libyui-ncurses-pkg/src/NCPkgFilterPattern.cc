@@ -230,9 +230,6 @@ NCursesEvent NCPkgFilterPattern::wHandleInput( wint_t ch )
 {
     NCursesEvent ret = NCursesEvent::none;
 
-    // call handleInput of NCPad
-    handleInput( ch );
-
     switch ( ch )
     {
         case KEY_UP:
@@ -241,10 +238,13 @@ NCursesEvent NCPkgFilterPattern::wHandleInput( wint_t ch )
         case KEY_PPAGE:
         case KEY_END:
         case KEY_HOME:
+            // call handleInput of NCPad
+            handleInput( ch );
             ret = NCursesEvent::handled;
             break;
 
         default:
+            // this calls handleInput() (only once!)
             ret = NCPkgTable::wHandleInput( ch );
             break;
     }
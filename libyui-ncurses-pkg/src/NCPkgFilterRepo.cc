@@ -87,6 +87,7 @@ NCPkgRepoTable::NCPkgRepoTable( YWidget *parent, YTableHeader *tableHeader, NCPa
     :NCTable( parent, tableHeader )
     , packager(pkg)
 {
+   setSearchColumn( 1 );	// the name, not the tag
    fillHeader();
    fillRepoList();
 }
@@ -340,7 +341,7 @@ ZyppProduct NCPkgRepoTable::findProductForRepo( ZyppRepo repo)
 NCursesEvent NCPkgRepoTable::wHandleInput( wint_t ch )
 {
     NCursesEvent ret = NCursesEvent::none;
-    handleInput( ch );
+    int oldItem = getCurrentItem();
 
     switch ( ch )
     {
@@ -350,12 +351,18 @@ NCursesEvent NCPkgRepoTable::wHandleInput( wint_t ch )
 	case KEY_PPAGE:
 	case KEY_END:
 	case KEY_HOME:
+	    handleInput( ch );
 	    ret = NCursesEvent::handled;
             showRepoPackages();
 	    break;
 
 	default:
+            // this calls handleInput() (only once!)
             ret = NCTable::wHandleInput( ch );
+
+            // type-ahead search
+            if ( getCurrentItem() != oldItem )
+                showRepoPackages();
 	    break;
     }
 
@@ -73,6 +73,7 @@ NCPkgServiceTable::NCPkgServiceTable( YWidget *parent, YTableHeader *tableHeader
     , packager(pkg)
     , repo_manager(new zypp::RepoManager())
 {
+   setSearchColumn( 1 );	// the name, not the tag
    fillHeader();
    fillServiceList();
 }
@@ -280,7 +281,7 @@ void NCPkgServiceTable::showServicePackages()
 NCursesEvent NCPkgServiceTable::wHandleInput( wint_t ch )
 {
     NCursesEvent ret = NCursesEvent::none;
-    handleInput( ch );
+    int oldItem = getCurrentItem();
 
     switch ( ch )
     {
@@ -290,12 +291,18 @@ NCursesEvent NCPkgServiceTable::wHandleInput( wint_t ch )
 	case KEY_PPAGE:
 	case KEY_END:
 	case KEY_HOME:
+	    handleInput( ch );
 	    ret = NCursesEvent::handled;
             showServicePackages();
 	    break;
 
 	default:
+            // this calls handleInput() (only once!)
             ret = NCTable::wHandleInput( ch );
+
+            // type-ahead search
+            if ( getCurrentItem() != oldItem )
+                showServicePackages();
             break;
     }
 
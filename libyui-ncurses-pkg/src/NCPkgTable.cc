@@ -130,6 +130,7 @@ NCPkgTable::NCPkgTable( YWidget * parent, YTableHeader * tableHeader )
     , haveInstalledVersion( false )
     , visibleInfo( I_Technical )
 {
+    setSearchColumn( 1 );	// the name, not the status
     yuiDebug() << "NCPkgTable created" << endl;
 }
 
@@ -766,6 +767,7 @@ bool NCPkgTable::showInformation()
 NCursesEvent NCPkgTable::wHandleInput( wint_t key )
 {
     NCursesEvent ret = NCursesEvent::none;
+    int oldItem = getCurrentItem();
 
     // call handleInput of NCPad
     handleInput( key );
@@ -806,8 +808,12 @@ NCursesEvent NCPkgTable::wHandleInput( wint_t key )
         case '*':
 	    // set the new status
 	    changeObjStatus( key );
+	    break;
 
 	default:
+	    // type-ahead search
+	    if ( getCurrentItem() != oldItem )
+		showInformation();
 	    break;
     }
 
@@ -13,14 +13,18 @@
   Floor, Boston, MA 02110-1301 USA
 */
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 
 #define	 YUILogComponent "ncurses-rest-api"
 #include <yui/YUILog.h>
 
 #include <yui/rest-api/YHttpServer.h>
+#include <yui/ncurses/NCTimer.h>
 
 #include "NCHttpDialog.h"
+#include "NCHttpEventLoop.h"
 
 
 NCHttpDialog::NCHttpDialog( YDialogType		dialogType,
@@ -32,11 +36,7 @@ NCHttpDialog::NCHttpDialog( YDialogType		dialogType,
 
 int NCHttpDialog::wait_for_input(int timeout_millisec)
 {
-    struct timeval tv;
-    fd_set fdset_read, fdset_write, fdset_excpt;
-
-    // infinite timout => do blocking select()
-    timeval *tv_ptr = (timeout_millisec < 0) ? nullptr : &tv;
+    NCHttpEventLoop & loop = NCHttpEventLoop::loop();
 
     // remember the original value
     int timeout_millisec_orig = timeout_millisec;
@@ -45,77 +45,26 @@ int NCHttpDialog::wait_for_input(int timeout_millisec)
     {
         std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-        tv.tv_sec  = 0;
-        tv.tv_usec = timeout_millisec * 1000;
-
-        FD_ZERO( &fdset_read );
-        FD_ZERO( &fdset_write );
-        FD_ZERO( &fdset_excpt );
-        FD_SET( 0,	&fdset_read );
-
-        // the higest fd number to watch
-        int fd_max = 0;
-
-        // watch HTTP server fd
-        yuiDebug() << "Adding HTTP server notifiers NC dialog..." << std::endl;
-        YHttpServerSockets sockets = YHttpServer::yserver()->sockets();
-
-        for(int fd: sockets.read())
-        {
-            FD_SET( fd, &fdset_read );
-            if (fd_max < fd) fd_max = fd;
-        }
-
-        for(int fd: sockets.write())
-        {
-            FD_SET( fd, &fdset_write );
-            if (fd_max < fd) fd_max = fd;
-        }
-
-        for(int fd: sockets.exception())
-        {
-            FD_SET( fd, &fdset_excpt );
-            if (fd_max < fd) fd_max = fd;
-        }
+        NCurses::FlushUpdate();
 
-        yuiDebug() << "Calling select()... " << std::endl;
-        int retval = select( fd_max + 1, &fdset_read, &fdset_write, &fdset_excpt, tv_ptr );
-        yuiDebug() << "select() result: " << retval << std::endl;
+        yuiDebug() << "Calling epoll_wait()... " << std::endl;
+        // wake up in time for the next NCTimer
+        int retval = loop.wait( NCTimer::waitTime( timeout_millisec ) );
+        yuiDebug() << "epoll_wait() result: " << retval << std::endl;
 
         if ( retval < 0 )
         {
             if ( errno != EINTR )
-                yuiError() << "error in select() (" << errno << ')' << std::endl;
+                yuiError() << "error in epoll_wait() (" << errno << ')' << std::endl;
         }
         else if ( retval != 0 )
         {
-            YHttpServerSockets sockets = YHttpServer::yserver()->sockets();
-            bool server_ready = false;
-
-            for(int fd: sockets.read())
-            {
-                if (FD_ISSET( fd, &fdset_read ))
-                    server_ready = true;
-            }
+            yuiDebug() << "Server ready: " << loop.server_ready() << std::endl;
 
-            for(int fd: sockets.write())
-            {
-                if (FD_ISSET( fd, &fdset_write ))
-                    server_ready = true;
-            }
-
-            for(int fd: sockets.exception())
-            {
-                if (FD_ISSET( fd, &fdset_excpt ))
-                    server_ready = true;
-            }
-
-            yuiDebug() << "Server ready: " << server_ready << std::endl;
-
-            if (server_ready)
+            if (loop.server_ready())
             {
                 bool redraw = YHttpServer::yserver()->process_data();
-                yuiWarning() << "redraw: " << redraw << std::endl;
+                yuiDebug() << "redraw: " << redraw << std::endl;
 
                 if (timeout_millisec > 0)
                 {
@@ -146,11 +95,25 @@ int NCHttpDialog::wait_for_input(int timeout_millisec)
         // no input within timeout
         else
         {
+            if ( runTimers() )
+            {
+                if ( timeout_millisec > 0 )
+                {
+                    std::chrono::steady_clock::time_point finish = std::chrono::steady_clock::now();
+                    int elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(finish - start).count();
+                    timeout_millisec = std::max( timeout_millisec - elapsed, 0 );
+                }
+
+                // only a timer woke us up, wait for the rest of the timeout
+                if ( timeout_millisec != 0 )
+                    continue;
+            }
+
             yuiDebug() << "Timeout " << timeout_millisec << "ms reached" << std::endl;
             return timeout_millisec_orig;
         }
     }
-    while ( !FD_ISSET( 0, &fdset_read ) );
+    while ( !loop.input_ready( 0 ) );
 
     // if there is an user input we do not need to spent the time
     return 0;
@@ -0,0 +1,182 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#include <cerrno>
+#include <unistd.h>
+
+#define	 YUILogComponent "ncurses-rest-api"
+#include <yui/YUILog.h>
+
+#include <yui/rest-api/YHttpServer.h>
+
+#include "NCHttpEventLoop.h"
+
+
+NCHttpEventLoop & NCHttpEventLoop::loop()
+{
+    static NCHttpEventLoop event_loop;
+    return event_loop;
+}
+
+
+NCHttpEventLoop::NCHttpEventLoop()
+    : _epoll_fd( epoll_create1( EPOLL_CLOEXEC ) )
+    , _ready_count( 0 )
+    , _server_ready( false )
+{
+    if ( _epoll_fd < 0 )
+        yuiError() << "Cannot create epoll FD (" << errno << ')' << std::endl;
+
+    // always watch the user input
+    watch_input( 0 );
+}
+
+
+NCHttpEventLoop::~NCHttpEventLoop()
+{
+    if ( _epoll_fd >= 0 )
+        close( _epoll_fd );
+}
+
+
+void NCHttpEventLoop::register_fd( int fd, uint32_t events )
+{
+    struct epoll_event event;
+    event.events = events;
+    event.data.fd = fd;
+
+    // a closed FD is automatically removed from the epoll set, its number
+    // might have been reused meanwhile so try adding it if it is missing
+    if ( epoll_ctl( _epoll_fd, EPOLL_CTL_MOD, fd, &event ) < 0 )
+    {
+        if ( errno != ENOENT || epoll_ctl( _epoll_fd, EPOLL_CTL_ADD, fd, &event ) < 0 )
+        {
+            // regular files cannot be watched by epoll, they are always
+            // ready for reading (the same as with select())
+            if ( errno == EPERM )
+                _always_ready.insert( fd );
+            else
+                yuiError() << "Cannot watch FD " << fd << " (" << errno << ')' << std::endl;
+        }
+    }
+}
+
+
+void NCHttpEventLoop::watch_input( int fd )
+{
+    register_fd( fd, EPOLLIN );
+}
+
+
+void NCHttpEventLoop::unwatch_input( int fd )
+{
+    _always_ready.erase( fd );
+    epoll_ctl( _epoll_fd, EPOLL_CTL_DEL, fd, nullptr );
+}
+
+
+void NCHttpEventLoop::update_server_fds()
+{
+    YHttpServer * server = YHttpServer::yserver();
+
+    if ( !server || !server->sockets_changed() )
+        return;
+
+    std::map<int, uint32_t> fds;
+    YHttpServerSockets sockets = server->sockets();
+
+    for ( int fd: sockets.read() )
+        fds[ fd ] |= EPOLLIN;
+
+    for ( int fd: sockets.write() )
+        fds[ fd ] |= EPOLLOUT;
+
+    for ( int fd: sockets.exception() )
+        fds[ fd ] |= EPOLLPRI;
+
+    // remove the FDs not used anymore (ignore errors, closed FDs are removed automatically)
+    for ( const auto & registered: _server_fds )
+    {
+        if ( fds.find( registered.first ) == fds.end() )
+            epoll_ctl( _epoll_fd, EPOLL_CTL_DEL, registered.first, nullptr );
+    }
+
+    for ( const auto & fd: fds )
+        register_fd( fd.first, fd.second );
+
+    yuiDebug() << "Watching " << fds.size() << " HTTP server FDs" << std::endl;
+    _server_fds.swap( fds );
+}
+
+
+int NCHttpEventLoop::wait( int timeout_millisec )
+{
+    update_server_fds();
+
+    _server_ready = false;
+    if ( !_always_ready.empty() || timeout_millisec < 0 )
+        timeout_millisec = _always_ready.empty() ? -1 : 0;
+
+    // the server might need to run even if none of its FDs gets ready
+    // (e.g. to continue a partial write in the MHD epoll mode)
+    YHttpServer * server = YHttpServer::yserver();
+    int server_timeout = server ? server->timeout() : -1;
+    bool server_due = server_timeout >= 0 &&
+        ( timeout_millisec < 0 || server_timeout <= timeout_millisec );
+
+    if ( server_due )
+        timeout_millisec = server_timeout;
+
+    _ready_count = epoll_wait( _epoll_fd, _events, max_events, timeout_millisec );
+
+    if ( _ready_count < 0 )
+    {
+        int error = errno;
+        _ready_count = 0;
+        errno = error;
+        return -1;
+    }
+
+    for ( int i = 0; i < _ready_count; ++i )
+    {
+        if ( _server_fds.find( _events[ i ].data.fd ) != _server_fds.end() )
+            _server_ready = true;
+    }
+
+    // the server timeout expired, report the server as ready
+    if ( _ready_count == 0 && server_due )
+    {
+        _server_ready = true;
+        return 1 + _always_ready.size();
+    }
+
+    return _ready_count + _always_ready.size();
+}
+
+
+bool NCHttpEventLoop::input_ready( int fd ) const
+{
+    if ( _always_ready.count( fd ) )
+        return true;
+
+    for ( int i = 0; i < _ready_count; ++i )
+    {
+        if ( _events[ i ].data.fd == fd && !_server_fds.count( fd ) )
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,99 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#ifndef NCHttpEventLoop_h
+#define NCHttpEventLoop_h
+
+#include <map>
+#include <set>
+#include <sys/epoll.h>
+
+
+/**
+ * The epoll based event loop for waiting on the user input and the REST API
+ * HTTP server at once. The FDs are registered only once and updated only
+ * when the HTTP server reports a change (with the MHD epoll mode the server
+ * FDs never change).
+ **/
+class NCHttpEventLoop
+{
+public:
+
+    /**
+     * Access the global event loop
+     **/
+    static NCHttpEventLoop & loop();
+
+    /**
+     * Watch the FD for reading (in addition to stdin which is always watched)
+     **/
+    void watch_input( int fd );
+
+    /**
+     * Stop watching the FD added by watch_input()
+     **/
+    void unwatch_input( int fd );
+
+    /**
+     * Wait until an input FD or the HTTP server is ready or the timeout
+     * expires. The HTTP server is also ready when its own timeout
+     * (YHttpServer::timeout()) expires.
+     * @param timeout_millisec timeout in milliseconds, negative value means
+     *     no timeout
+     * @return the number of the ready FDs (the HTTP server counts as one
+     *     if only its timeout expired), 0 on timeout, -1 on error
+     *     (see errno)
+     */
+    int wait( int timeout_millisec );
+
+    /**
+     * Has the HTTP server any data to process? (after the last wait() call)
+     **/
+    bool server_ready() const { return _server_ready; }
+
+    /**
+     * Is the input FD ready for reading? (after the last wait() call)
+     **/
+    bool input_ready( int fd ) const;
+
+private:
+
+    NCHttpEventLoop();
+    ~NCHttpEventLoop();
+
+    // disable copying
+    NCHttpEventLoop( const NCHttpEventLoop & ) = delete;
+    NCHttpEventLoop & operator=( const NCHttpEventLoop & ) = delete;
+
+    // synchronize the registered FDs with the current HTTP server FDs
+    void update_server_fds();
+
+    void register_fd( int fd, uint32_t events );
+
+    static const int max_events = 16;
+
+    int _epoll_fd;
+    // the registered HTTP server FDs => epoll events
+    std::map<int, uint32_t> _server_fds;
+    // the input FDs which cannot be watched by epoll (regular files)
+    std::set<int> _always_ready;
+    // the result of the last wait() call
+    struct epoll_event _events[ max_events ];
+    int _ready_count;
+    bool _server_ready;
+};
+
+#endif // NCHttpEventLoop_h
@@ -26,6 +26,8 @@
 #include "YNCHttpWidgetsActionHandler.h"
 #include "NCHttpWidgetFactory.h"
 #include "NCHttpDialog.h"
+#include "NCHttpEventLoop.h"
+#include "NCTimer.h"
 
 
 YNCHttpUI::YNCHttpUI( bool withThreads )
@@ -55,82 +57,35 @@ extern YUI * createYNCHttpUI( bool withThreads )
 void YNCHttpUI::idleLoop( int fd_ycp )
 {
     int	   timeout = 5;
-
-    struct timeval tv;
-    fd_set fdset_read, fdset_write, fdset_excpt;
     int	   retval;
 
+    NCHttpEventLoop & loop = NCHttpEventLoop::loop();
+    loop.watch_input( fd_ycp );
+
     do
     {
-        tv.tv_sec  = timeout;
- 	tv.tv_usec = 0;
-
- 	FD_ZERO( &fdset_read );
- 	FD_ZERO( &fdset_write );
- 	FD_ZERO( &fdset_excpt );
- 	FD_SET( 0,	&fdset_read );
- 	FD_SET( fd_ycp, &fdset_read );
-
-        // the higest fd number to watch
-        int fd_max = fd_ycp;
+         yuiDebug() << "Calling epoll_wait()... " << std::endl;
+         // wake up for the NCTimers (e.g. busy indicator animations), too
+         retval = loop.wait( NCTimer::waitTime( timeout * 1000 ) );
+         yuiDebug() << "epoll_wait() result: " << retval << std::endl;
 
-         // watch HTTP server fd
-         yuiDebug() << "Adding HTTP server notifiers..." << std::endl;
-         YHttpServerSockets sockets = YHttpServer::yserver()->sockets();
-
-         for(int fd: sockets.read())
-         {
-             FD_SET( fd, &fdset_read );
-             if (fd_max < fd) fd_max = fd;
-         }
-
-         for(int fd: sockets.write())
-         {
-             FD_SET( fd, &fdset_write );
-             if (fd_max < fd) fd_max = fd;
-         }
-
-         for(int fd: sockets.exception())
-         {
-             FD_SET( fd, &fdset_excpt );
-             if (fd_max < fd) fd_max = fd;
-         }
+         NCDialog * timerDialog = static_cast<NCDialog *>( YDialog::currentDialog( false ) );
 
-         yuiDebug() << "Calling select()... " << std::endl;
-         retval = select( fd_max + 1, &fdset_read, &fdset_write, &fdset_excpt, &tv );
-         yuiDebug() << "select() result: " << retval << std::endl;
+         if ( timerDialog )
+             timerDialog->runTimers();
+         else
+             NCTimer::runDueTimers();
 
          if ( retval < 0 )
          {
              if ( errno != EINTR )
- 	           yuiError() << "idleLoop error in select() (" << errno << ')' << std::endl;
+ 	           yuiError() << "idleLoop error in epoll_wait() (" << errno << ')' << std::endl;
          }
          else if ( retval != 0 )
          {
-             YHttpServerSockets sockets = YHttpServer::yserver()->sockets();
-             bool server_ready = false;
+             yuiDebug() << "Server ready: " << loop.server_ready() << std::endl;
 
-             for(int fd: sockets.read())
-             {
-                 if (FD_ISSET( fd, &fdset_read ))
-                     server_ready = true;
-             }
-
-             for(int fd: sockets.write())
-             {
-                 if (FD_ISSET( fd, &fdset_write ))
-                     server_ready = true;
-             }
-
-             for(int fd: sockets.exception())
-             {
-                 if (FD_ISSET( fd, &fdset_excpt ))
-                     server_ready = true;
-             }
-
-             yuiDebug() << "Server ready: " << server_ready << std::endl;
-
-             if (server_ready)
+             if (loop.server_ready())
              {
                 bool redraw = YHttpServer::yserver()->process_data();
                 if (redraw)
@@ -148,17 +103,14 @@ void YNCHttpUI::idleLoop( int fd_ycp )
  		if ( ncd )
  		{
                     yuiDebug() << "Casted to NCHttpDialog" << std::endl;
- 		    extern NCBusyIndicator* NCBusyIndicatorObject;
-
- 		    if ( NCBusyIndicatorObject )
- 			NCBusyIndicatorObject->handler( 0 );
-
  		    ncd->idleInput();
  		}
  	    }
  	} // else no input within timeout sec.
     }
-    while ( !FD_ISSET( fd_ycp, &fdset_read ) );
+    while ( !loop.input_ready( fd_ycp ) );
+
+    loop.unwatch_input( fd_ycp );
 }
 
 YWidgetFactory *
@@ -0,0 +1,387 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+/*
+ * Terminal output benchmark for the ncurses UI.
+ *
+ * Runs a dialog with a table, an input field and some buttons in a
+ * pseudo terminal, sends keystrokes to it and counts the bytes the UI
+ * writes to the terminal for each of them. This is what matters on slow
+ * serial consoles and SSH connections.
+ *
+ * Usage:
+ *
+ *   yui-ncurses-benchmark [--rows N] [--keys N] [--lines N] [--cols N]
+ *                         [--term TERM] [--settle MSEC] [--log FILE]
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#define YUILogComponent "ncurses-benchmark"
+#include <yui/YUILog.h>
+
+#include <yui/YUI.h>
+#include <yui/YDialog.h>
+#include <yui/YEvent.h>
+#include <yui/YLayoutBox.h>
+#include <yui/YPushButton.h>
+#include <yui/YTable.h>
+#include <yui/YTableHeader.h>
+#include <yui/YTableItem.h>
+#include <yui/YWidgetFactory.h>
+
+// before <pty.h>: NCurses.h defines CTRL() without checking
+#include "YNCursesUI.h"
+
+#include <poll.h>
+#include <pty.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// last: term.h defines macros for all terminfo capabilities
+#include <ncursesw/term.h>
+
+using std::string;
+using std::vector;
+
+
+struct BenchOptions
+{
+    int    rows     = 1000;
+    int    keys     = 50;
+    int    height   = 30;
+    int    width    = 100;
+    int    settle   = 100;      // msec without output after a keystroke
+    string term     = "xterm";
+    string log      = "/dev/null";
+};
+
+
+/**
+ * A sequence of keystrokes to measure.
+ **/
+struct Scenario
+{
+    string name;
+    string prepare;     // keys sent before measuring (not counted)
+    string key;         // the measured keystroke, sent --keys times
+};
+
+
+static void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n\n"
+              << "  --rows N          number of table rows\n"
+              << "  --keys N          number of keystrokes per scenario\n"
+              << "  --lines N         terminal height\n"
+              << "  --cols N          terminal width\n"
+              << "  --term TERM       terminal type (default xterm)\n"
+              << "  --settle MSEC     time without output after which a keystroke\n"
+              << "                    is considered completely processed\n"
+              << "  --log FILE        libyui log file (default /dev/null)\n";
+    exit( 1 );
+}
+
+
+static BenchOptions parseArgs( int argc, char ** argv )
+{
+    BenchOptions opts;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if      ( arg == "--rows"   && hasValue ) opts.rows   = atoi( argv[++i] );
+        else if ( arg == "--keys"   && hasValue ) opts.keys   = atoi( argv[++i] );
+        else if ( arg == "--lines"  && hasValue ) opts.height = atoi( argv[++i] );
+        else if ( arg == "--cols"   && hasValue ) opts.width  = atoi( argv[++i] );
+        else if ( arg == "--settle" && hasValue ) opts.settle = atoi( argv[++i] );
+        else if ( arg == "--term"   && hasValue ) opts.term   = argv[++i];
+        else if ( arg == "--log"    && hasValue ) opts.log    = argv[++i];
+        else usage( argv[0] );
+    }
+
+    opts.keys   = std::max( opts.keys,   1 );
+    opts.settle = std::max( opts.settle, 10 );
+
+    return opts;
+}
+
+
+//
+// The UI side, running in the child process
+//
+
+static void runDialog( const BenchOptions & opts )
+{
+    YUILog::setLogFileName( opts.log );
+    createUI( false );
+
+    YWidgetFactory * factory = YUI::widgetFactory();
+    YDialog *        dialog  = factory->createMainDialog();
+    YLayoutBox *     vbox    = factory->createVBox( dialog );
+
+    YTableHeader * header = new YTableHeader();
+    header->addColumn( "Name" );
+    header->addColumn( "Size", YAlignEnd );
+    header->addColumn( "Summary" );
+
+    YTable * table = factory->createTable( vbox, header );
+    YItemCollection items;
+
+    for ( int i = 0; i < opts.rows; i++ )
+    {
+        items.push_back( new YTableItem( "package-" + std::to_string( i ),
+                                         std::to_string( ( i * 7919 ) % 100000 ) + " kB",
+                                         "Summary of package number " + std::to_string( i ) ) );
+    }
+
+    table->addItems( items );
+
+    factory->createInputField( vbox, "&Filter" );
+
+    YLayoutBox * hbox = factory->createHBox( vbox );
+    factory->createPushButton( hbox, "&OK" );
+    factory->createPushButton( hbox, "&Details" );
+    YPushButton * cancel = factory->createPushButton( hbox, "&Cancel" );
+
+    while ( true )
+    {
+        YEvent * event = dialog->waitForEvent();
+
+        if ( event && ( event->eventType() == YEvent::CancelEvent ||
+                        event->widget() == cancel ) )
+            break;
+    }
+
+    dialog->destroy();
+}
+
+
+//
+// The terminal side, running in the parent process
+//
+
+/**
+ * Read the terminal output until there was none for 'settle' milliseconds.
+ * Return the number of bytes read or -1 if the UI is gone.
+ **/
+static long readOutput( int fd, int settle )
+{
+    long total = 0;
+    char buffer[ 16384 ];
+
+    while ( true )
+    {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int ret = poll( &pfd, 1, settle );
+
+        if ( ret < 0 && errno == EINTR )
+            continue;
+
+        if ( ret <= 0 )
+            return total;
+
+        ssize_t len = read( fd, buffer, sizeof( buffer ) );
+
+        if ( len < 0 && errno == EINTR )
+            continue;
+
+        if ( len <= 0 )
+            return total > 0 ? total : -1;
+
+        total += len;
+    }
+}
+
+
+/**
+ * Return the string the terminal sends for a key from its terminfo entry.
+ **/
+static string terminalKey( const char * capability, const string & fallback )
+{
+    char * value = tigetstr( capability );
+
+    if ( ! value || value == (char *) -1 )
+        return fallback;
+
+    return value;
+}
+
+
+static bool sendKeys( int fd, const string & keys )
+{
+    return write( fd, keys.data(), keys.size() ) == (ssize_t) keys.size();
+}
+
+
+/**
+ * Return the CPU time (user and system) the UI process used so far in
+ * milliseconds.
+ **/
+static long cpuTime( pid_t pid )
+{
+    std::ifstream stat( "/proc/" + std::to_string( pid ) + "/stat" );
+    string field;
+
+    // utime and stime are fields 14 and 15; the process name in field 2
+    // does not contain blanks here
+    for ( int i = 1; i < 14 && stat >> field; i++ )
+        ;
+
+    long utime = 0;
+    long stime = 0;
+    stat >> utime >> stime;
+
+    return ( utime + stime ) * 1000 / sysconf( _SC_CLK_TCK );
+}
+
+
+static void report( const string & name, vector<long> & bytes, long cpu )
+{
+    if ( bytes.empty() )
+        return;
+
+    std::sort( bytes.begin(), bytes.end() );
+
+    long total = 0;
+
+    for ( long count : bytes )
+        total += count;
+
+    std::cout << std::left  << std::setw( 14 ) << name
+              << std::right << std::setw( 6 )  << bytes.size()
+              << std::setw( 10 ) << total
+              << std::setw( 10 ) << total / (long) bytes.size()
+              << std::setw( 10 ) << bytes[ bytes.size() / 2 ]
+              << std::setw( 10 ) << bytes.back()
+              << std::setw( 10 ) << cpu
+              << std::endl;
+}
+
+
+int main( int argc, char ** argv )
+{
+    BenchOptions opts = parseArgs( argc, argv );
+
+    struct winsize size = {};
+    size.ws_row = opts.height;
+    size.ws_col = opts.width;
+
+    int   fd  = -1;
+    pid_t pid = forkpty( &fd, 0, 0, &size );
+
+    if ( pid < 0 )
+    {
+        perror( "forkpty" );
+        return 1;
+    }
+
+    if ( pid == 0 )
+    {
+        setenv( "TERM", opts.term.c_str(), 1 );
+        runDialog( opts );
+        _exit( 0 );
+    }
+
+    int err = 0;
+    setupterm( opts.term.c_str(), 1, &err );
+
+    const string downKey     = terminalKey( "kcud1", "\033[B"  );
+    const string pageDownKey = terminalKey( "knp",   "\033[6~" );
+    const string tabKey      = "\t";
+
+    // The table has the initial keyboard focus; the input field is the next
+    // widget. Ctrl-L repaints the whole screen, so it is the worst case.
+
+    vector<Scenario> scenarios =
+    {
+        { "table-down",   "",     downKey     },
+        { "table-pgdown", "",     pageDownKey },
+        { "typing",       tabKey, "x"         },
+        { "focus-tab",    "",     tabKey      },
+        { "refresh",      "",     "\014"      }   // Ctrl-L
+    };
+
+    long startup = readOutput( fd, std::max( opts.settle, 1000 ) );
+
+    if ( startup < 0 )
+    {
+        std::cerr << "The UI did not start" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Terminal:  " << opts.term << " " << opts.width << "x" << opts.height
+              << ", " << opts.rows << " table rows" << std::endl
+              << "Startup:   " << startup << " bytes" << std::endl << std::endl
+              << std::left  << std::setw( 14 ) << "Keystroke"
+              << std::right << std::setw( 6 )  << "count"
+              << std::setw( 10 ) << "bytes"
+              << std::setw( 10 ) << "avg"
+              << std::setw( 10 ) << "p50"
+              << std::setw( 10 ) << "max"
+              << std::setw( 10 ) << "cpu ms"
+              << std::endl;
+
+    bool ok = true;
+
+    for ( const Scenario & scenario : scenarios )
+    {
+        vector<long> bytes;
+
+        if ( ! scenario.prepare.empty() )
+        {
+            ok = sendKeys( fd, scenario.prepare ) && readOutput( fd, opts.settle ) >= 0;
+        }
+
+        long cpu = cpuTime( pid );
+
+        for ( int i = 0; ok && i < opts.keys; i++ )
+        {
+            long count = -1;
+
+            if ( sendKeys( fd, scenario.key ) )
+                count = readOutput( fd, opts.settle );
+
+            if ( count < 0 )
+                ok = false;
+            else
+                bytes.push_back( count );
+        }
+
+        report( scenario.name, bytes, cpuTime( pid ) - cpu );
+    }
+
+    kill( pid, SIGTERM );
+    waitpid( pid, 0, 0 );
+
+    if ( ! ok )
+    {
+        std::cerr << "The UI terminated unexpectedly" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,187 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+/*
+ * Word wrapper benchmark for the ncurses UI.
+ *
+ * Wraps a generated help text of several megabytes (Latin and CJK
+ * paragraphs) with NCWordWrapper and reports the time for a complete wrap,
+ * for rewrapping to a different width and for the incremental cases
+ * (appending text, changing text near the end).
+ *
+ * Usage:
+ *
+ *   yui-ncurses-wrap-benchmark [--size MB] [--width N] [--repeat N]
+ */
+
+#include <chrono>
+#include <clocale>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "NCWordWrapper.h"
+
+using std::string;
+using std::wstring;
+
+
+struct BenchOptions
+{
+    int size   = 4;     // MB of text
+    int width  = 78;
+    int repeat = 100;   // number of appends and edits
+};
+
+
+static void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n\n"
+              << "  --size MB         size of the text to wrap\n"
+              << "  --width N         line width\n"
+              << "  --repeat N        number of incremental changes\n";
+    exit( 1 );
+}
+
+
+static BenchOptions parseArgs( int argc, char ** argv )
+{
+    BenchOptions opts;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if      ( arg == "--size"   && hasValue ) opts.size   = atoi( argv[++i] );
+        else if ( arg == "--width"  && hasValue ) opts.width  = atoi( argv[++i] );
+        else if ( arg == "--repeat" && hasValue ) opts.repeat = atoi( argv[++i] );
+        else usage( argv[0] );
+    }
+
+    opts.size   = std::max( opts.size,   1 );
+    opts.width  = std::max( opts.width,  2 );
+    opts.repeat = std::max( opts.repeat, 1 );
+
+    return opts;
+}
+
+
+/**
+ * Return a paragraph of help text. Every fourth one is Japanese, i.e.
+ * double-width characters without any whitespace.
+ **/
+static wstring paragraph( int no )
+{
+    if ( no % 4 == 3 )
+        return L"インストールするパッケージを選択してください。依存関係は自動的に解決されます。"
+               L"変更を適用する前に概要を確認してください。\n\n";
+
+    return L"Select the packages to install. Dependencies are resolved automatically; "
+           L"conflicts are shown in a separate dialog (see the \"Dependencies\" menu). "
+           L"Paragraph number " + std::to_wstring( no ) + L" of the help text.\n\n";
+}
+
+
+/**
+ * Return the milliseconds since 'start'.
+ **/
+static double millisecSince( std::chrono::steady_clock::time_point start )
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+
+static void report( const string & name, double millisec, int count = 1 )
+{
+    std::cout << std::left  << std::setw( 16 ) << name
+              << std::right << std::setw( 8 )  << count
+              << std::fixed << std::setprecision( 3 )
+              << std::setw( 14 ) << millisec
+              << std::setw( 14 ) << millisec / count
+              << std::endl;
+}
+
+
+int main( int argc, char ** argv )
+{
+    BenchOptions opts = parseArgs( argc, argv );
+
+    // Needed for wcwidth() of the CJK characters
+    setlocale( LC_ALL, "" );
+
+    wstring text;
+    int     paragraphs = 0;
+
+    while ( text.size() < (size_t) opts.size * 1024 * 1024 )
+        text += paragraph( paragraphs++ );
+
+    std::cout << "Text:      " << text.size() << " characters, "
+              << paragraphs << " paragraphs" << std::endl
+              << "Width:     " << opts.width << " columns" << std::endl << std::endl
+              << std::left  << std::setw( 16 ) << "Operation"
+              << std::right << std::setw( 8 )  << "count"
+              << std::setw( 14 ) << "total ms"
+              << std::setw( 14 ) << "avg ms"
+              << std::endl;
+
+    NCWordWrapper wrapper;
+    wrapper.setLineWidth( opts.width );
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    wrapper.setText( text );
+    int lines = wrapper.lines();
+    report( "wrap", millisecSince( start ) );
+
+    start = std::chrono::steady_clock::now();
+    wrapper.setLineWidth( opts.width / 2 );
+    wrapper.lines();
+    wrapper.setLineWidth( opts.width );
+    wrapper.lines();
+    report( "resize", millisecSince( start ), 2 );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( int i = 0; i < opts.repeat; i++ )
+    {
+        wrapper.appendText( paragraph( paragraphs++ ) );
+        wrapper.lines();
+    }
+
+    report( "append", millisecSince( start ), opts.repeat );
+
+    // Change a word in the last paragraph. This includes comparing the old
+    // and the new text to find the change.
+
+    text = wrapper.origText();
+    start = std::chrono::steady_clock::now();
+
+    for ( int i = 0; i < opts.repeat; i++ )
+    {
+        text[ text.size() - 20 ] = ( i % 2 ) ? L'x' : L'y';
+        wrapper.setText( text );
+        wrapper.lines();
+    }
+
+    report( "edit-end", millisecSince( start ), opts.repeat );
+
+    std::cout << std::endl << "Wrapped lines: " << lines << std::endl;
+
+    return 0;
+}
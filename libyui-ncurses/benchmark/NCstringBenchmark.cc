@@ -0,0 +1,233 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+/*
+ * String recoding benchmark for the ncurses UI.
+ *
+ * Recodes short strings (like labels and table cells) and long ones (like
+ * rich text and logs) between UTF-8 and wide characters with NCstring and,
+ * for comparison, with plain iconv, and reports the throughput in
+ * characters per second.
+ *
+ * Usage:
+ *
+ *   yui-ncurses-string-benchmark [--size KB] [--repeat N]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iconv.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "NCstring.h"
+
+using std::string;
+using std::wstring;
+
+
+struct BenchOptions
+{
+    int size   = 256;   // KB of text for the long strings
+    int repeat = 20;    // number of recodings of the long strings
+};
+
+
+static void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n\n"
+              << "  --size KB         size of the long strings\n"
+              << "  --repeat N        number of recodings of the long strings\n";
+    exit( 1 );
+}
+
+
+static BenchOptions parseArgs( int argc, char ** argv )
+{
+    BenchOptions opts;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if      ( arg == "--size"   && hasValue ) opts.size   = atoi( argv[++i] );
+        else if ( arg == "--repeat" && hasValue ) opts.repeat = atoi( argv[++i] );
+        else usage( argv[0] );
+    }
+
+    opts.size   = std::max( opts.size,   1 );
+    opts.repeat = std::max( opts.repeat, 1 );
+
+    return opts;
+}
+
+
+/**
+ * Recode with iconv like NCstring did before it had a fast path for UTF-8:
+ * one iconv call into a temporary buffer for each string.
+ **/
+static void iconvToWchar( iconv_t cd, const string & in, wstring * out )
+{
+    iconv( cd, 0, 0, 0, 0 );
+
+    std::vector<char> buffer( in.size() * sizeof( wchar_t ) + sizeof( wchar_t ) );
+    char * inPtr   = (char *) in.data();
+    size_t inLen   = in.size();
+    char * outPtr  = buffer.data();
+    size_t outLen  = buffer.size();
+
+    iconv( cd, &inPtr, &inLen, &outPtr, &outLen );
+    out->assign( (wchar_t *) buffer.data(), ( outPtr - buffer.data() ) / sizeof( wchar_t ) );
+}
+
+
+static void iconvFromWchar( iconv_t cd, const wstring & in, string * out )
+{
+    iconv( cd, 0, 0, 0, 0 );
+
+    std::vector<char> buffer( in.size() * sizeof( wchar_t ) * 2 );
+    char * inPtr   = (char *) in.data();
+    size_t inLen   = in.size() * sizeof( wchar_t );
+    char * outPtr  = buffer.data();
+    size_t outLen  = buffer.size();
+
+    iconv( cd, &inPtr, &inLen, &outPtr, &outLen );
+    out->assign( buffer.data(), outPtr - buffer.data() );
+}
+
+
+/**
+ * Return the milliseconds since 'start'.
+ **/
+static double millisecSince( std::chrono::steady_clock::time_point start )
+{
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count();
+}
+
+
+static void report( const string & name, double millisec, size_t chars )
+{
+    std::cout << std::left  << std::setw( 26 ) << name
+              << std::right << std::fixed << std::setprecision( 3 )
+              << std::setw( 12 ) << millisec
+              << std::setprecision( 1 )
+              << std::setw( 14 ) << chars / millisec / 1000.0
+              << std::endl;
+}
+
+
+/**
+ * Recode 'strings' to wide characters and back 'repeat' times with NCstring
+ * and with iconv and report the results.
+ **/
+static void benchmark( const string & name, const std::vector<string> & strings, int repeat )
+{
+    iconv_t toWchar   = iconv_open( "WCHAR_T", "UTF-8" );
+    iconv_t fromWchar = iconv_open( "UTF-8", "WCHAR_T" );
+
+    std::vector<wstring> wstrings( strings.size() );
+    size_t chars = 0;
+
+    for ( size_t i = 0; i < strings.size(); i++ )
+    {
+        NCstring::RecodeToWchar( strings[i], "UTF-8", &wstrings[i] );
+        chars += wstrings[i].size();
+    }
+
+    chars *= repeat;
+
+    wstring wout;
+    string  out;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for ( int r = 0; r < repeat; r++ )
+        for ( const string & str : strings )
+            NCstring::RecodeToWchar( str, "UTF-8", &wout );
+
+    report( name + " to wchar", millisecSince( start ), chars );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( int r = 0; r < repeat; r++ )
+        for ( const string & str : strings )
+            iconvToWchar( toWchar, str, &wout );
+
+    report( name + " to wchar (iconv)", millisecSince( start ), chars );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( int r = 0; r < repeat; r++ )
+        for ( const wstring & wstr : wstrings )
+            NCstring::RecodeFromWchar( wstr, "UTF-8", &out );
+
+    report( name + " to UTF-8", millisecSince( start ), chars );
+
+    start = std::chrono::steady_clock::now();
+
+    for ( int r = 0; r < repeat; r++ )
+        for ( const wstring & wstr : wstrings )
+            iconvFromWchar( fromWchar, wstr, &out );
+
+    report( name + " to UTF-8 (iconv)", millisecSince( start ), chars );
+
+    iconv_close( toWchar );
+    iconv_close( fromWchar );
+}
+
+
+int main( int argc, char ** argv )
+{
+    BenchOptions opts = parseArgs( argc, argv );
+
+    const string ascii = "Select the packages to install, dependencies are resolved automatically. ";
+    const string latin = "Wählen Sie die zu installierenden Pakete aus, Abhängigkeiten werden aufgelöst. ";
+    const string cjk   = "インストールするパッケージを選択してください。依存関係は自動的に解決されます。";
+
+    std::cout << std::left  << std::setw( 26 ) << "Recoding"
+              << std::right << std::setw( 12 ) << "ms"
+              << std::setw( 14 ) << "Mchars/s"
+              << std::endl;
+
+    // Many short strings like labels and table cells
+
+    std::vector<string> cells;
+
+    for ( int i = 0; i < 100000; i++ )
+        cells.push_back( "package-" + std::to_string( i ) );
+
+    benchmark( "cells", cells, 1 );
+
+    // Long strings like rich text or a log
+
+    for ( const string * text : { &ascii, &latin, &cjk } )
+    {
+        string longText;
+
+        while ( longText.size() < (size_t) opts.size * 1024 )
+            longText += *text;
+
+        string name = ( text == &ascii ? "ascii" : text == &latin ? "latin" : "cjk" );
+        benchmark( name, { longText }, opts.repeat );
+    }
+
+    return 0;
+}
@@ -54,7 +54,7 @@ NCApplication::setLanguage( const std::string & language,
     // This would implicitly overwrite LC_CTYPE which might result in encoding bugs.
 
     setlocale( LC_NUMERIC, "C" );	// always format numbers with "."
-    NCurses::Refresh();
+    NCurses::Update();
 
     yuiDebug() << "Language: " << language << " Encoding: " << (( encoding != "" ) ? encoding : "NOT SET" ) << std::endl;
 
@@ -27,41 +27,23 @@
 #include <yui/YUILog.h>
 #include "NCurses.h"
 #include "NCBusyIndicator.h"
-#include <signal.h>
-#include <unistd.h>
-#include <sys/time.h>
 
 #define REPAINT_INTERVAL	100	// in ms
 #define STEP_SIZE		.05
 
 /*
  Some words about the timer stuff:
- With each SIG_ALRM signal _timer_progress gets incremented by _timer_divisor.
- When a tick is received [=setAlive(true) is called] _timer_progress is std::set to 0.
+ With each tick of _timer _timer_progress gets incremented by _timer_divisor.
+ When a tick is received [=setAlive(true) is called] _timer_progress is set to 0.
  If _timer_progress is larger than 1 the widget goes to stalled state.
 
  How the timer works:
- NCBusyIndicatorHandlerWrapper is registered as signal handler for SIG_ALRM
- signal and calls NCBusyIndicatorObject->handler(). This wrapper is needed
- because a member function cannot be registered as signal handler.
-
- LIMITATIONS:
- i)  Only one BusyIndicator widget works at the same time, because the
-     wrapper function only calls the handler() member function of the last
-     created instance of BusyIndicator.
-
- ii) The UserInput widget cannot be used, because UserInput is a blocking
-     function. When UserInput waits for UserInput no SIG_ALRM signal is sent
-     and therefore the BusyIndicator widget doesn't show progress.
-     Please use the TimeoutUserInput widget in a loop instead.
+ _timer is an NCTimer, its callbacks are called while the dialog waits for
+ input (also in UserInput) or while the UI is idle in YNCursesUI::idleLoop().
+ The dialog is updated on the screen once after all due timers ran, so any
+ number of busy indicators animate together.
 */
 
-struct itimerval interval;
-NCBusyIndicator* NCBusyIndicatorObject;
-#if 0
-void NCBusyIndicatorHandlerWrapper( int sig_num );
-#endif
-
 
 
 NCBusyIndicator::NCBusyIndicator( YWidget * parent,
@@ -76,6 +58,7 @@ NCBusyIndicator::NCBusyIndicator( YWidget * parent,
     , _position( .5 )
     , _rightwards( true )
     , _alive( true )
+    , _timer( REPAINT_INTERVAL, [this]() { tick(); } )
 {
     // yuiDebug() << std::endl;
 
@@ -85,22 +68,14 @@ NCBusyIndicator::NCBusyIndicator( YWidget * parent,
     setLabel( nlabel );
     hotlabel = &_label;
     wstate = NC::WSdumb;
-    NCBusyIndicatorObject = this;
     _timer_divisor = (double) REPAINT_INTERVAL / (double) timeout;
     _timer_progress = 0;
-
-#if 0
-    signal( SIGALRM, NCBusyIndicatorHandlerWrapper );
-    interval.it_value.tv_sec = 0;
-    interval.it_value.tv_usec = REPAINT_INTERVAL * 1000;
-    setitimer( ITIMER_REAL, &interval, NULL );
-#endif
+    _timer.start();
 }
 
 
 NCBusyIndicator::~NCBusyIndicator()
 {
-    NCBusyIndicatorObject = NULL;
     delete _lwin;
     delete _twin;
     // yuiDebug() << std::endl;
@@ -188,9 +163,9 @@ void NCBusyIndicator::setLabel( const std::string & nlabel )
 
 
 /**
- * handler, called by NCBusyIndicatorHandlerWrapper
+ * Called by _timer every REPAINT_INTERVAL ms
  **/
-void NCBusyIndicator::handler( int sig_num )
+void NCBusyIndicator::tick()
 {
     _timer_progress += _timer_divisor;
 
@@ -201,30 +176,9 @@ void NCBusyIndicator::handler( int sig_num )
     }
 
     update();
-
-#if 0
-    interval.it_value.tv_sec = 0;
-    interval.it_value.tv_usec = REPAINT_INTERVAL * 1000;
-    setitimer( ITIMER_REAL, &interval, NULL );
-#endif
-
 }
 
 
-/**
- * static wrapper for member function handler
- **/
-#if 0
-void NCBusyIndicatorHandlerWrapper( int sig_num )
-{
-    signal( SIGALRM, SIG_IGN );
-    NCBusyIndicatorObject->handler( sig_num );
-    signal( SIGALRM, NCBusyIndicatorHandlerWrapper );
-}
-
-#endif
-
-
 /**
  * Calculate position of moving bar
  **/
@@ -241,8 +195,8 @@ void NCBusyIndicator::update()
     else
 	_position -= STEP_SIZE;
 
+    // no refresh(): the dialog is updated once after all timers ran
     Redraw();
-    refresh();
 }
 
 
@@ -30,12 +30,7 @@
 
 #include <yui/YBusyIndicator.h>
 #include "NCWidget.h"
-
-
-class NCBusyIndicator;
-
-
-
+#include "NCTimer.h"
 
 
 class NCBusyIndicator : public YBusyIndicator, public NCWidget
@@ -57,12 +52,14 @@ private:
     void setDefsze();
     void tUpdate();
     void update();
+    void tick();
 
     float	_position;		// the position of the bar
     bool	_rightwards;		// direction the bar moves
     bool	_alive;			// the widget is alive or stalled
     float	_timer_divisor;		// =repaint interval devided by timeout
     float	_timer_progress;	// progress until widget goes to stalled state
+    NCTimer	_timer;			// drives the animation
 
 
 protected:
@@ -96,10 +93,6 @@ public:
     virtual void setEnabled( bool do_bv );
 
     int timeout()   const   { return _timeout;	}
-
-    void handler( int sig_num );
-
-    static void staticHandler( int sig_num );
 };
 
 
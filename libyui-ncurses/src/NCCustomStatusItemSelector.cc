@@ -72,7 +72,15 @@ void NCCustomStatusItemSelector::updateCustomStatusIndicator( YItem * item )
     NCCustomStatusTableTag * tag = (NCCustomStatusTableTag *) item->data();
     YUI_CHECK_PTR( tag );
 
+    // The line of the item is not known here, so the column widths can't be
+    // updated for just this line if the indicator width changes.
+    unsigned oldWidth = tag->Size().W;
+
     tag->updateStatusIndicator();
+
+    if ( (unsigned) tag->Size().W != oldWidth )
+        myPad()->CellWidthChanged();
+
     DrawPad();
 }
 
@@ -37,8 +37,13 @@ textdomain "ncurses"
 #include <yui/YDialogSpy.h>
 #include <yui/YDialog.h>
 
+#include "NCTimer.h"
 #include "ncursesw.h"
 
+#include <chrono>
+#include <cstring>
+#include <poll.h>
+
 
 static bool hiddenMenu()
 {
@@ -804,54 +809,89 @@ wint_t NCDialog::getinput()
 }
 
 
-wint_t NCDialog::getch( int timeout_millisec )
+/**
+ * Return the number of milliseconds (rounded up) until 'deadline'.
+ **/
+static int millisecUntil( const std::chrono::steady_clock::time_point & deadline )
 {
-    wint_t got = WEOF;
+    using namespace std::chrono;
+
+    steady_clock::duration remaining = deadline - steady_clock::now();
 
-    if ( timeout_millisec < 0 )
+    if ( remaining <= steady_clock::duration::zero() )
+	return 0;
+
+    return duration_cast<milliseconds>( remaining + milliseconds( 1 ) - nanoseconds( 1 ) ).count();
+}
+
+
+bool NCDialog::waitForInput( int timeout_millisec )
+{
+    std::chrono::steady_clock::time_point deadline =
+	std::chrono::steady_clock::now() + std::chrono::milliseconds( std::max( timeout_millisec, 0 ) );
+
+    while ( true )
     {
-	// wait for input
-	::nodelay( ::stdscr, false );
+	runTimers();
+
+	int remaining = -1;
+
+	if ( timeout_millisec >= 0 )
+	{
+	    remaining = millisecUntil( deadline );
 
-	got = getinput();
+	    if ( remaining == 0 )
+		return false;
+	}
+
+	// the screen must be up to date while waiting
+	NCurses::FlushUpdate();
+
+	struct pollfd pfd = { NCurses::inputFileDescriptor(), POLLIN, 0 };
+	int ret = ::poll( &pfd, 1, NCTimer::waitTime( remaining ) );
+
+	// EINTR: let the caller check for a KEY_RESIZE from the SIGWINCH handler
+	if ( ret > 0 || ( ret < 0 && errno == EINTR ) )
+	    return true;
 
+	if ( ret < 0 )
+	{
+	    yuiError() << "poll() failed: " << strerror( errno ) << std::endl;
+	    return false;
+	}
     }
-    else if ( timeout_millisec )
+}
+
+
+wint_t NCDialog::getch( int timeout_millisec )
+{
+    // Never block in ncurses, wait in poll() instead: This is accurate to
+    // the millisecond (halfdelay() is not), has no upper limit and lets us
+    // run the NCTimers while waiting.
+    ::nodelay( ::stdscr, true );
+
+    // ncurses might still have buffered input
+    wint_t got = getinput();
+
+    if ( got == WEOF && timeout_millisec != 0 )
     {
-	// max halfdelay is 25 seconds (250 tenths of seconds)
-	do
+	std::chrono::steady_clock::time_point deadline =
+	    std::chrono::steady_clock::now() + std::chrono::milliseconds( std::max( timeout_millisec, 0 ) );
+
+	while ( got == WEOF )
 	{
-	    if ( timeout_millisec > 25000 )
-	    {
-		::halfdelay( 250 );
-		timeout_millisec -= 25000;
-	    }
-	    else
-	    {
-		if ( timeout_millisec < 100 )
-		{
-		    // min halfdelay is 1/10 second (100 milliseconds)
-		    ::halfdelay( 1 );
-		}
-		else
-		    ::halfdelay( timeout_millisec / 100 );
+	    int remaining = timeout_millisec < 0 ? -1 : millisecUntil( deadline );
 
-		timeout_millisec = 0;
-	    }
+	    if ( remaining == 0 || ! waitForInput( remaining ) )
+		break;
 
+	    // WEOF again e.g. for an incomplete escape sequence
 	    got = getinput();
 	}
-	while ( got == WEOF && timeout_millisec > 0 );
-
-	::cbreak(); // stop halfdelay
-    }
-    else
-    {
-	// no wait
-	::nodelay( ::stdscr, true );
-	got = getinput();
     }
 
+    ::nodelay( ::stdscr, false );
+
     if ( got == KEY_RESIZE )
     {
 	NCurses::ResizeEvent();
@@ -888,6 +928,18 @@ bool NCDialog::flushTypeahead()
 }
 
 
+bool NCDialog::runTimers()
+{
+    NCurses::UpdateBatch batch;
+
+    if ( ! NCTimer::runDueTimers() )
+	return false;
+
+    doUpdate();
+    return true;
+}
+
+
 void NCDialog::idleInput()
 {
     if ( !pan )
@@ -944,6 +996,9 @@ NCursesEvent NCDialog::pollInput()
 	}
     }
 
+    // a throttled update might still be pending from the last call
+    NCurses::FlushUpdate();
+
     NCursesEvent returnEvent = pendingEvent;
 
     eventReason = returnEvent.reason;
@@ -1053,7 +1108,19 @@ void NCDialog::processInput( int timeout_millisec )
 	// bug #182982
 	if ( timeout_millisec > 0 )
 	{
-	    usleep( timeout_millisec * 1000 );
+	    // sleep, but keep the timers running; don't touch the input, any
+	    // typeahead is for the next dialog
+	    std::chrono::steady_clock::time_point deadline =
+		std::chrono::steady_clock::now() + std::chrono::milliseconds( timeout_millisec );
+	    int remaining;
+
+	    while ( ( remaining = millisecUntil( deadline ) ) > 0 )
+	    {
+		NCurses::FlushUpdate();
+		usleep( NCTimer::waitTime( remaining ) * 1000 );
+		runTimers();
+	    }
+
 	    pendingEvent = NCursesEvent::timeout;
 	}
 
@@ -1074,6 +1141,9 @@ void NCDialog::processInput( int timeout_millisec )
 
 	ch = getch( timeout_millisec );
 
+	// one screen update for everything this key changes
+	NCurses::UpdateBatch batch;
+
 	switch ( ch )
 	{
 	    // case KEY_RESIZE: is directly handled in NCDialog::getch.
@@ -107,6 +107,13 @@ private:
 
     bool flushTypeahead();
 
+    /**
+     * Wait until there is input on the terminal, but at most
+     * 'timeout_millisec' milliseconds (-1: no limit). Run the due NCTimers
+     * meanwhile. Return 'true' if there is (or might be) input.
+     **/
+    bool waitForInput( int timeout_millisec );
+
 protected:
 
     virtual wint_t getch( int timeout_millisec = -1 );
@@ -160,6 +167,12 @@ public:
 
     void idleInput();
 
+    /**
+     * Run the due NCTimers and update the dialog on the screen once if any
+     * of them was due. Return 'true' in that case.
+     **/
+    bool runTimers();
+
     NCursesEvent userInput( int timeout_millisec = -1 );
     NCursesEvent pollInput();
 
@@ -176,6 +176,7 @@ NCFileSelection::NCFileSelection( YWidget *           parent,
     , tableType( type )
 {
     SetSepChar( ' ' );
+    setSearchColumn( 1 );	// the name, not the type tag
 
     struct stat64 statInfo;
 
@@ -527,6 +528,8 @@ NCursesEvent NCFileTable::wHandleInput( wint_t key )
     if ( ret == NCursesEvent::key )
 	return ret;
 
+    int old_pos = getCurrentItem();
+
     // call handleInput of NCPad
     handleInput( key );
 
@@ -548,6 +551,13 @@ NCursesEvent NCFileTable::wHandleInput( wint_t key )
 
 	default:
 	    ret = NCursesEvent::none;
+
+	    // type-ahead search
+	    if ( getCurrentItem() != old_pos )
+	    {
+		ret = NCursesEvent::SelectionChanged;
+		ret.result = currentFile;
+	    }
     }
 
     // yuiDebug() << "CURRENT_FILE: " << currentFile << endl;
@@ -830,6 +840,14 @@ NCursesEvent NCDirectoryTable::wHandleInput( wint_t key )
 
 	default:
 	    ret = NCursesEvent::none;
+
+	    // type-ahead search
+	    if ( (unsigned) getCurrentItem() != old_pos )
+	    {
+		setCurrentDir();
+		ret = NCursesEvent::SelectionChanged;
+		ret.result = currentDir;
+	    }
     }
 
     // yuiDebug() << "CURRENT: " << currentDir << " START DIR: " << startDir << endl;
@@ -25,6 +25,10 @@
 #define  YUILogComponent "ncurses"
 #include <yui/YUILog.h>
 #include "NCLogView.h"
+#include "NCVirtualPad.h"
+
+#include <algorithm>
+#include <boost/algorithm/string.hpp>
 
 
 NCLogView::NCLogView( YWidget * parent,
@@ -33,10 +37,14 @@ NCLogView::NCLogView( YWidget * parent,
 		      int maxLines )
 	: YLogView( parent, nlabel, visibleLines, maxLines )
 	, NCPadWidget( parent )
+	, _textStart( 0 )
+	, _wrapWidth( 0 )
 {
     // yuiDebug() << std::endl;
     defsze = wsze( visibleLines, 5 ) + 2;
     setLabel( nlabel );
+    setAppendHandler( [this]( const std::string & newLines, const std::string & droppedText )
+		      { displayAppendedLines( newLines, droppedText ); } );
 }
 
 
@@ -82,16 +90,143 @@ void NCLogView::setLabel( const std::string & nlabel )
 void NCLogView::displayLogText( const std::string & ntext )
 {
     DelPad();
-    text = NCtext( NCstring( ntext ), Columns() );
+
+    _text = NCstring( ntext ).str();
+    boost::erase_all( _text, L"\r" );	// handle DOS text
+
+    // the last newline is cut off from 'ntext'
+    if ( !_text.empty() && !lastLine().empty() && *lastLine().rbegin() == '\n' )
+	_text += L'\n';
+
+    _textStart = 0;
+    _lines.clear();
+    _wrapWidth = 0;	// wrapped in DrawPad()
+
     Redraw();
 }
 
 
+void NCLogView::displayAppendedLines( const std::string & newLines,
+				      const std::string & droppedText )
+{
+    dropText( droppedText );
+
+    // a last line without a newline is continued by the new text
+    size_t from = _text.size();
+
+    if ( from > _textStart && _text[ from - 1 ] != L'\n' )
+    {
+	from = _text.rfind( L'\n', from - 1 );
+	from = ( from == std::wstring::npos || from < _textStart ) ? _textStart : from + 1;
+
+	while ( !_lines.empty() && _lines.back().start >= from )
+	    _lines.pop_back();
+    }
+
+    std::wstring text( NCstring( newLines ).str() );
+    boost::erase_all( text, L"\r" );	// handle DOS text
+    _text += text;
+
+    if ( _wrapWidth )	// otherwise DrawPad() wraps everything
+	wrapLines( from );
+
+    if ( _wrapWidth && myPad() && myPad()->Destwin() )
+    {
+	AdjustPad( wsze( Lines(), _wrapWidth ) );
+	myPad()->ScrlTo( wpos( Lines(), 0 ) );
+	Update();
+    }
+    else
+    {
+	DelPad();
+	Redraw();
+    }
+}
+
+
+void NCLogView::dropText( const std::string & droppedText )
+{
+    if ( droppedText.empty() )
+	return;
+
+    // _text is the recoded log text without '\r', so skip as much of it
+    std::wstring dropped( NCstring( droppedText ).str() );
+    size_t len = dropped.size() - std::count( dropped.begin(), dropped.end(), L'\r' );
+
+    _textStart = std::min( _textStart + len, _text.size() );
+
+    while ( !_lines.empty() && _lines.front().start < _textStart )
+	_lines.pop_front();
+
+    // The dropped text may end within a log line (an appended text without
+    // a trailing newline): Wrap the rest of that line again
+    if ( _wrapWidth && _textStart > 0 && _textStart < _text.size()
+	 && _text[ _textStart - 1 ] != L'\n' )
+    {
+	size_t end = _text.find( L'\n', _textStart );
+
+	if ( end == std::wstring::npos )
+	    end = _text.size();
+
+	while ( !_lines.empty() && _lines.front().start <= end )
+	    _lines.pop_front();
+
+	std::deque<Line> lines;
+	wrapLine( _textStart, end, lines );
+	_lines.insert( _lines.begin(), lines.begin(), lines.end() );
+    }
+
+    // Remove the dropped text when it is the larger part: This moves the
+    // remaining text only after as much text was dropped, so dropping has
+    // a constant cost per line on average.
+    if ( _textStart > _text.size() / 2 )
+    {
+	_text.erase( 0, _textStart );
+
+	for ( Line & line : _lines )
+	    line.start -= _textStart;
+
+	_textStart = 0;
+    }
+}
+
+
+void NCLogView::wrapLines( size_t from )
+{
+    while ( from < _text.size() )
+    {
+	size_t end = _text.find( L'\n', from );
+
+	if ( end == std::wstring::npos )
+	    end = _text.size();
+
+	wrapLine( from, end, _lines );
+	from = end + 1;
+    }
+}
+
+
+void NCLogView::wrapLine( size_t from, size_t end, std::deque<Line> & lines ) const
+{
+    size_t columns = std::max( _wrapWidth, 2U );
+
+    size_t len = std::min( end - from, columns );
+    lines.push_back( { from, (unsigned) len, false } );
+
+    for ( size_t start = from + len; start < end; start += columns - 1 )
+	lines.push_back( { start, (unsigned) std::min( end - start, columns - 1 ), true } );
+}
+
+
 void NCLogView::wRedraw()
 {
     if ( !win )
 	return;
 
+    // After a resize break the lines for the new width
+    if ( myPad() && !myPad()->Destwin() && _wrapWidth != (unsigned) defPadSze().W )
+	DelPad();
+
     bool initial = ( !myPad() || !myPad()->Destwin() );
 
     if ( myPad() )
@@ -100,7 +235,7 @@ void NCLogView::wRedraw()
     NCPadWidget::wRedraw();
 
     if ( initial )
-	myPad()->ScrlTo( wpos( text.Lines(), 0 ) );
+	myPad()->ScrlTo( wpos( Lines(), 0 ) );
 }
 
 
@@ -121,7 +256,11 @@ NCursesEvent NCLogView::wHandleInput( wint_t key )
 NCPad * NCLogView::CreatePad()
 {
     wsze psze( defPadSze() );
-    NCPad * npad = new NCPad( psze.H, psze.W, *this );
+    NCPad * npad = new NCVirtualPad( psze.H, psze.W, *this,
+				     [this]( NCursesWindow & w, int row, unsigned lineNo )
+				     {
+					 drawLine( w, row, lineNo );
+				     } );
     npad->bkgd( listStyle().item.plain );
     return npad;
 }
@@ -129,32 +268,35 @@ NCPad * NCLogView::CreatePad()
 
 void NCLogView::DrawPad()
 {
-    // maximal value for lines is 32000!
-    unsigned maxLines = 20000;
-    unsigned skipLines = 0;
-    unsigned lines = text.Lines();
-    unsigned cl = 0;
+    // Nothing is drawn here, the pad is paging: Only the visible lines are
+    // drawn by drawLine() when the pad is updated. So there is no limit
+    // for the number of lines.
 
-    if ( lines > maxLines )
-    {
-	skipLines = lines - maxLines;
-	lines = maxLines;
-    }
+    unsigned width = defPadSze().W;
 
-    AdjustPad( wsze( lines, Columns() ) );
-
-    for ( NCtext::const_iterator line = text.begin(); line != text.end(); ++line )
+    if ( width != _wrapWidth )
     {
-	if ( skipLines == 0 )
-	{
-	    myPad()->move( cl++, 0 );
-	    std::wstring cline = ( *line ).str();
-	    myPad()->addwstr( cline.c_str() );
-	}
-	else
-	{
-	    skipLines--;
-	}
+	_lines.clear();
+	_wrapWidth = width;
+	wrapLines( _textStart );
     }
+
+    AdjustPad( wsze( Lines(), width ) );
 }
 
+
+void NCLogView::drawLine( NCursesWindow & w, int row, unsigned lineNo )
+{
+    w.move( row, 0 );
+    w.clrtoeol();
+
+    if ( lineNo >= Lines() )
+	return;
+
+    const Line & line = _lines[ lineNo ];
+
+    if ( line.continued )
+	w.addwstr( L"~" );
+
+    w.addwstr( _text.data() + line.start, line.length );
+}
@@ -25,7 +25,9 @@
 #ifndef NCLogView_h
 #define NCLogView_h
 
+#include <deque>
 #include <iosfwd>
+#include <string>
 
 #include <yui/YLogView.h>
 #include "NCPadWidget.h"
@@ -41,7 +43,53 @@ private:
     NCLogView( const NCLogView & );
 
 
-    NCtext text;
+    /**
+     * A screen line: A part of a log line in _text, continuation lines are
+     * drawn with a leading '~'.
+     **/
+    struct Line
+    {
+	size_t	 start;
+	unsigned length;
+	bool	 continued;
+    };
+
+    std::wstring	_text;		// the log text, lines separated by '\n'
+    size_t		_textStart;	// the text before was dropped (maxLines)
+    std::deque<Line>	_lines;		// the screen lines for _wrapWidth
+    unsigned		_wrapWidth;
+
+    unsigned Lines() const { return _lines.size(); }
+
+    /**
+     * Break the log text from offset 'from' on into screen lines of at
+     * most _wrapWidth characters and append them to _lines.
+     **/
+    void wrapLines( size_t from );
+
+    /**
+     * Break the log line from 'from' to 'end' into screen lines and append
+     * them to 'lines'.
+     **/
+    void wrapLine( size_t from, size_t end, std::deque<Line> & lines ) const;
+
+    /**
+     * Remove 'droppedText' from the start of the log text.
+     **/
+    void dropText( const std::string & droppedText );
+
+    /**
+     * Handler for YLogView::appendLines(): Recode and wrap only the new
+     * lines and scroll to the end without drawing the whole log again.
+     **/
+    void displayAppendedLines( const std::string & newLines,
+			       const std::string & droppedText );
+
+    /**
+     * Draw log line 'lineNo' into row 'row' of 'w'. This is the
+     * NCVirtualPad::LineDrawer of the pad.
+     **/
+    void drawLine( NCursesWindow & w, int row, unsigned lineNo );
 
 protected:
 
@@ -212,6 +212,7 @@ NCPad * NCMultiSelectionBox::CreatePad()
     NCTablePad * npad = new NCTablePad( psze.H, psze.W, *this );
     npad->bkgd( listStyle().item.plain );
     npad->SetSepChar( ' ' );
+    npad->SetSearchCol( 1 );	// the label, not the "[x]" tag
     return npad;
 }
 
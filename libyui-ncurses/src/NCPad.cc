@@ -22,13 +22,16 @@
 
 /-*/
 
+#include <algorithm>
+
 #define  YUILogComponent "ncurses"
 #include <yui/YUILog.h>
 #include "NCPad.h"
 
 
-// PAD_PAGESIZE needs to be large enough to feed any destwin. We
-// get in throuble here if the terminal has more than 1024 lines.
+// PAD_PAGESIZE needs to be large enough to feed any destwin, it is used
+// when the destwin is not known yet. We get in throuble here if the
+// terminal has more than 1024 lines.
 #define PAD_PAGESIZE 1024
 
 // Maximum height of the NCursesPad (e.g. in case it can't hold more
@@ -40,6 +43,7 @@
 NCPad::NCPad( int lines, int cols, const NCWidget & p )
   : NCursesPad( lines > MAX_PAD_HEIGHT ? PAD_PAGESIZE : lines, cols )
   , _vheight( lines > MAX_PAD_HEIGHT ? lines : 0 )
+  , _maxPadHeight( MAX_PAD_HEIGHT )
   , parw( p )
   , destwin ( 0 )
   , maxdpos ( 0 )
@@ -49,6 +53,13 @@ NCPad::NCPad( int lines, int cols, const NCWidget & p )
 {}
 
 
+int NCPad::pageHeight( const NCursesWindow * dwin ) const
+{
+    // only the visible lines are drawn into the truncated pad
+    return dwin ? std::max( dwin->height(), 1 ) : PAD_PAGESIZE;
+}
+
+
 void NCPad::Destwin( NCursesWindow * dwin )
 {
     if ( dwin != destwin )
@@ -57,6 +68,9 @@ void NCPad::Destwin( NCursesWindow * dwin )
 
 	if ( destwin )
 	{
+	    if ( paging() && height() != pageHeight( destwin ) )
+		NCursesPad::resize( pageHeight( destwin ), width() );
+
 	    wsze mysze( vheight(), width() );
 
 	    drect = wrect( 0, wsze( destwin->height(), destwin->width() ) );
@@ -81,17 +95,18 @@ void NCPad::resize( wsze nsze )
     SetPadSize( nsze ); // might be enlarged by NCPadWidget if redirected
 
     if ( nsze.H != vheight()
-	 || nsze.W != width() )
+	 || nsze.W != width()
+	 || ( nsze.H > _maxPadHeight ) != paging() )	// setMaxPadHeight() changed
     {
 	NCursesWindow * odest = Destwin();
 
 	if ( odest )
 	    Destwin( 0 );
 
-        if ( nsze.H > MAX_PAD_HEIGHT )
+        if ( nsze.H > _maxPadHeight )
         {
-	    // yuiDebug() << "TRUNCATE PAD: " << nsze.H << " > " << MAX_PAD_HEIGHT << std::endl;
-	    NCursesPad::resize( PAD_PAGESIZE, nsze.W );
+	    // yuiDebug() << "TRUNCATE PAD: " << nsze.H << " > " << _maxPadHeight << std::endl;
+	    NCursesPad::resize( pageHeight( odest ), nsze.W );
 	    _vheight = nsze.H;
         }
         else
@@ -121,13 +121,20 @@ private:
      * more than 32768 lines). If \ref resize truncated the window, the real
      * size is in \ref _vheight. Longer lists need to be paged.
      *
-     * \todo Once all NCPad based types are able to page, \a maxPadHeight could be
-     * std::set to e.g \c 1024 to avoid bigger widgets in memory. Currently just
-     * \ref NCTablePad supports paging. If paging is \c ON, all content lines are
-     * written via \ref directDraw. Without paging \ref DoRedraw is reponsible for this.
+     * The types able to page (\ref NCTablePadBase, \ref NCVirtualPad) lower the limit with
+     * \ref setMaxPadHeight to avoid big pads in memory. If paging is \c ON,
+     * the pad has only the size of the viewport and all content lines are
+     * written via \ref directDraw. Without paging \ref DoRedraw is
+     * reponsible for this.
      */
     int   _vheight;
 
+    /** Pads with more lines are truncated and paged, see \ref _vheight. */
+    int   _maxPadHeight;
+
+    /** The height of the truncated pad when drawing into \a dwin. */
+    int pageHeight( const NCursesWindow * dwin ) const;
+
 protected:
 
     const NCWidget & parw;
@@ -148,6 +155,13 @@ protected:
     /** Whether the Pad is truncated (we're paging). */
     bool paging() const { return _vheight; }
 
+    /**
+     * Set the maximum height of the pad, higher pads are paged. Only for the
+     * derived classes which implement \ref directDraw. Takes effect on the
+     * next \ref resize.
+     */
+    void setMaxPadHeight( int lines ) { _maxPadHeight = lines; }
+
     virtual int dirtyPad() { dirty = false; return setpos( CurPos() ); }
 
     /// Set the visible position to *newpos* (but clamp by *maxspos*), then \ref update.
@@ -25,9 +25,11 @@
 #define	 YUILogComponent "ncurses"
 #include <yui/YUILog.h>
 #include "NCRichText.h"
+#include "NCVirtualPad.h"
 #include "YNCursesUI.h"
 #include "stringutil.h"
 #include "stdutil.h"
+#include <algorithm>
 #include <sstream>
 #include <boost/algorithm/string.hpp>
 
@@ -37,6 +39,10 @@
 using stdutil::form;
 
 
+// Number of layouts (for different widths) to keep
+#define MAX_CACHED_LAYOUTS	3
+
+
 const unsigned NCRichText::listindent = 4;
 const std::wstring	NCRichText::listleveltags( L"@*+o#-%$&" );//
 
@@ -144,22 +150,19 @@ const std::wstring NCRichText::filterEntities( const std::wstring & text )
 }
 
 
-void NCRichText::Anchor::draw( NCPad & pad, const chtype attr, int color )
+void NCRichText::Anchor::draw( NCursesWindow & w, int row, unsigned line, const chtype attr, int color )
 {
-    unsigned l = sline;
-    unsigned c = scol;
+    if ( line < sline || line > eline )
+	return;
 
-    while ( l < eline )
-    {
-	pad.move( l, c );
-	pad.chgat( -1, attr, color );
-	++l;
-	c = 0;
-    }
+    unsigned c = ( line == sline ? scol : 0 );
 
-    pad.move( l, c );
+    w.move( row, c );
 
-    pad.chgat( ecol - c, attr, color );
+    if ( line < eline )
+	w.chgat( -1, attr, color );
+    else
+	w.chgat( ecol - c, attr, color );
 }
 
 
@@ -176,6 +179,7 @@ NCRichText::NCRichText( YWidget * parent, const std::string & ntext,
 	, atbol( true )
 	, preTag( false )
 	, Tattr( 0 )
+	, _layout( 0 )
 {
     // yuiDebug() << std::endl;
     activeLabelOnly = true;
@@ -226,6 +230,12 @@ void NCRichText::setValue( const std::string & ntext )
     DelPad();
     text = NCstring( ntext );
     YRichText::setValue( ntext );
+
+    clearLayouts();
+
+    if ( !plainText )
+	ParseHTML();
+
     Redraw();
 }
 
@@ -235,6 +245,13 @@ void NCRichText::wRedraw()
     if ( !win )
 	return;
 
+    // After a resize reflow the text into the new width
+    if ( !plainText && myPad() && !myPad()->Destwin()
+	 && _layout && _layout->width != (unsigned) defPadSze().W )
+    {
+	DelPad();
+    }
+
     bool initial = ( !myPad() || !myPad()->Destwin() );
 
     if ( !( plainText || anchors.empty() ) )
@@ -244,7 +261,7 @@ void NCRichText::wRedraw()
 
     if ( initial && autoScrollDown() )
     {
-	myPad()->ScrlTo( wpos( myPad()->maxy(), 0 ) );
+	myPad()->ScrlToLastLine();
     }
 
     return;
@@ -300,70 +317,183 @@ NCPad * NCRichText::CreatePad()
 {
     wsze psze( defPadSze() );
     textwidth = psze.W;
-    NCPad * npad = new NCPad( psze.H, textwidth, *this );
+    NCPad * npad = new NCVirtualPad( psze.H, textwidth, *this,
+				     [this]( NCursesWindow & w, int row, unsigned lineNo )
+				     {
+					 drawLine( w, row, lineNo );
+				     } );
     return npad;
 }
 
 
 void NCRichText::DrawPad()
 {
+    const Layout & layout = layoutFor( defPadSze().W );
+
 #if 0
     yuiDebug() << "Start: plain mode " << plainText << std::endl
                << "       padsize " << myPad()->size() << std::endl
                << "       text length " << text.str().size() << std::endl;
 #endif
 
-    myPad()->bkgdset( wStyle().richtext.plain );
-    myPad()->clear();
+    // Nothing is drawn here, the pad is paging: Only the visible lines are
+    // drawn by drawLine() when the pad is updated.
+    AdjustPad( wsze( layout.lines, layout.padWidth ) );
+
+    anchors = layout.anchors;
+    armed = Anchor::unset;
+    visitedAnchors.clear();
+
+    // yuiDebug() << "Done" << std::endl;
+}
 
+
+const NCRichText::Layout & NCRichText::layoutFor( unsigned width )
+{
     if ( plainText )
-	DrawPlainPad();
+	width = 0;	// does not depend on the width
+
+    for ( std::list<Layout>::iterator it = _layouts.begin(); it != _layouts.end(); ++it )
+    {
+	if ( it->width == width )
+	{
+	    _layouts.splice( _layouts.begin(), _layouts, it );
+	    _layout = &_layouts.front();
+
+	    return *_layout;
+	}
+    }
+
+    _layouts.push_front( Layout( width ) );
+    _layout = &_layouts.front();
+
+    if ( plainText )
+	LayoutPlain();
     else
-	DrawHTMLPad();
+	LayoutHTML();
 
-    // yuiDebug() << "Done" << std::endl;
+    // index the segments by line for drawLine()
+    std::vector<Layout::Segment> & segments = _layout->segments;
+    _layout->lineSegment.resize( _layout->lines + 1 );
+
+    for ( unsigned line = 0, seg = 0; line <= _layout->lines; ++line )
+    {
+	while ( seg < segments.size() && segments[ seg ].line < line )
+	    ++seg;
+
+	_layout->lineSegment[ line ] = seg;
+    }
+
+    if ( _layouts.size() > MAX_CACHED_LAYOUTS )
+	_layouts.pop_back();
+
+    return *_layout;
 }
 
 
-void NCRichText::DrawPlainPad()
+void NCRichText::drawLine( NCursesWindow & w, int row, unsigned lineNo )
 {
-    NCtext ftext( text );
-    // yuiDebug() << "ftext is " << wsze( ftext.Lines(), ftext.Columns() ) << std::endl;
+    w.bkgdset( wStyle().richtext.plain );
+    w.move( row, 0 );
+    w.clrtoeol();
 
-    AdjustPad( wsze( ftext.Lines(), ftext.Columns() ) );
+    if ( !_layout || lineNo >= _layout->lines )
+	return;
 
-    cl = 0;
+    const Layout & layout = *_layout;
 
-    for ( NCtext::const_iterator line = ftext.begin();
-	  line != ftext.end(); ++line, ++cl )
+    for ( unsigned seg = layout.lineSegment[ lineNo ]; seg < layout.lineSegment[ lineNo + 1 ]; ++seg )
     {
-	myPad()->addwstr( cl, 0, ( *line ).str().c_str() );
+	const Layout::Segment & segment = layout.segments[ seg ];
+
+	unsigned endPiece = ( seg + 1 < layout.segments.size() ?
+			      layout.segments[ seg + 1 ].firstPiece : layout.pieces.size() );
+	unsigned start    = ( segment.firstPiece ? layout.pieces[ segment.firstPiece - 1 ].end : 0 );
+
+	w.move( row, segment.col );
+
+	for ( unsigned i = segment.firstPiece; i < endPiece; ++i )
+	{
+	    const Layout::Piece & piece = layout.pieces[i];
+
+	    w.bkgdset( textAttr( piece.attr ) );
+	    w.addwstr( layout.text.data() + start, piece.end - start );
+	    start = piece.end;
+	}
     }
+
+    w.bkgdset( wStyle().richtext.plain );
+
+    for ( unsigned i : visitedAnchors )
+	anchors[i].draw( w, row, lineNo, wStyle().richtext.link, (int) wStyle().richtext.visitedlink );
+
+    if ( armed != Anchor::unset )
+	anchors[armed].draw( w, row, lineNo, wStyle().richtext.getArmed( GetState() ), 0 );
 }
 
-void NCRichText::PadPreTXT( const wchar_t * osch, const unsigned olen )
+
+void NCRichText::clearLayouts()
 {
-    std::wstring wtxt( osch, olen );
+    _layouts.clear();
+    _layout = 0;
+}
 
-    // resolve the entities even in PRE (#71718)
-    wtxt = filterEntities( wtxt );
 
-    NCstring nctxt( wtxt );
-    NCtext ftext( nctxt );
+void NCRichText::LayoutMove( unsigned line, unsigned col )
+{
+    std::vector<Layout::Segment> & segments = _layout->segments;
+
+    // nothing added since the last move: just replace it
+    if ( !segments.empty() && segments.back().firstPiece == _layout->pieces.size() )
+	segments.pop_back();
+
+    segments.push_back( { line, col, (unsigned) _layout->pieces.size() } );
+}
 
-    // insert the text
-    const wchar_t * sch = wtxt.data();
 
-    while ( *sch )
+void NCRichText::LayoutAdd( const wchar_t * sch, size_t len )
+{
+    if ( !len )
+	return;
+
+    std::vector<Layout::Piece> & pieces = _layout->pieces;
+
+    _layout->text.append( sch, len );
+
+    // continue the last piece if it has the same attributes
+    if ( pieces.size() > _layout->segments.back().firstPiece
+	 && pieces.back().attr == Tattr )
     {
-	myPad()->addwstr( sch, 1 );	// add one wide chararacter
+	pieces.back().end = _layout->text.size();
+    }
+    else
+    {
+	pieces.push_back( { Tattr, (unsigned) _layout->text.size() } );
+    }
+}
 
-	++sch;
+
+void NCRichText::LayoutPlain()
+{
+    NCtext ftext( text );
+    // yuiDebug() << "ftext is " << wsze( ftext.Lines(), ftext.Columns() ) << std::endl;
+
+    _layout->lines    = ftext.Lines();
+    _layout->padWidth = ftext.Columns();
+
+    Tattr = 0;
+    cl = 0;
+
+    for ( NCtext::const_iterator line = ftext.begin();
+	  line != ftext.end(); ++line, ++cl )
+    {
+	LayoutMove( cl, 0 );
+	LayoutAdd( ( *line ).str().data(), ( *line ).str().size() );
     }
 }
 
 //
-// DrawHTMLPad tools
+// ParseHTML tools
 //
 
 inline void SkipToken( const wchar_t *& wch )
@@ -419,9 +549,8 @@ inline void SkipPreTXT( const wchar_t *& wch )
 
 //
 // Calculate longest line of text in <pre> </pre> tags
-// and adjust the pad accordingly
 //
-void NCRichText::AdjustPrePad( const wchar_t *osch )
+size_t NCRichText::PreWidth( const wchar_t *osch )
 {
     const wchar_t * wch = osch;
     std::wstring wstr( wch, 6 );
@@ -462,28 +591,33 @@ void NCRichText::AdjustPrePad( const wchar_t *osch )
     }
     // yuiDebug() << "Longest line: " << llen << std::endl;
 
-    if ( llen > textwidth )
+    return llen;
+}
+
+
+void NCRichText::AddToken( Token::Type type, const std::wstring & txt )
+{
+    Token token = { (unsigned char) type, false, false, 0,
+		    (unsigned) _tokenText.size(), (unsigned) txt.size(), 0 };
+
+    if ( type == Token::Word )
     {
-	textwidth = llen;
-	AdjustPad( wsze( cl + ftext.Lines(), llen ) );	// adjust pad to longest line
+	token.param  = textWidth( txt );
+	token.simple = std::all_of( txt.begin(), txt.end(), []( wchar_t c ) { return NCstring::charWidth( c ) >= 0; } );
     }
 
+    _tokenText += txt;
+    _tokens.push_back( token );
 }
 
-void NCRichText::DrawHTMLPad()
+
+void NCRichText::ParseHTML()
 {
     // yuiDebug() << "Start:" << std::endl;
 
-    liststack = std::stack<int>();
-    canchor = Anchor();
-    anchors.clear();
-    armed = Anchor::unset;
-
-    cl = 0;
-    cc = 0;
-    cindent = 0;
-    myPad()->move( cl, cc );
-    atbol = true;
+    _tokens.clear();
+    _tokenText.clear();
+    preTag = false;
 
     const wchar_t * wch = ( wchar_t * )text.str().data();
     const wchar_t * swch = 0;
@@ -501,7 +635,7 @@ void NCRichText::DrawHTMLPad()
 		if ( ! preTag )
 		{
 		    SkipWS( wch );
-		    PadWS();
+		    AddToken( Token::Space );
 		}
 		else
 		{
@@ -509,12 +643,12 @@ void NCRichText::DrawHTMLPad()
 		    {
 			case L' ':	// add white space
 			case L'\t':
-			    myPad()->addwstr( wch, 1 );
+			    AddToken( Token::PreText, std::wstring( wch, 1 ) );
 			    break;
 
 			case L'\n':
                         case L'\f':
-			    PadNL();	// add new line
+			    AddToken( Token::Newline );	// add new line
 			    break;
 
 			default:
@@ -529,7 +663,7 @@ void NCRichText::DrawHTMLPad()
 		swch = wch;
 		SkipToken( wch );
 
-		if ( PadTOKEN( swch, wch ) )
+		if ( ParseTOKEN( swch, wch ) )
 		    break;	// strip token
 		else
 		    wch = swch;		// reset and fall through
@@ -540,30 +674,78 @@ void NCRichText::DrawHTMLPad()
 		if ( !preTag )
 		{
 		    SkipWord( wch );
-		    PadTXT( swch, wch - swch );
+		    AddToken( Token::Word, filterEntities( std::wstring( swch, wch - swch ) ) );
 		}
 		else
 		{
 		    SkipPreTXT( wch );
-		    PadPreTXT( swch, wch - swch );
+		    // resolve the entities even in PRE (#71718)
+		    AddToken( Token::PreText, filterEntities( std::wstring( swch, wch - swch ) ) );
 		}
 
 		break;
 	}
     }
 
+    preTag = false;
+}
+
+
+void NCRichText::LayoutHTML()
+{
+    liststack = std::stack<int>();
+    canchor = Anchor();
+
+    textwidth = _layout->width;
+    cl = 0;
+    cc = 0;
+    cindent = 0;
+    Tattr = 0;
+    LayoutMove( cl, cc );
+    atbol = true;
+
+    for ( const Token & token : _tokens )
+    {
+	const wchar_t * sch = _tokenText.data() + token.start;
+
+	switch ( token.type )
+	{
+	    case Token::Space:
+		PadWS();
+		break;
+
+	    case Token::Word:
+		PadTXT( sch, token.length, token.param, token.simple );
+		break;
+
+	    case Token::PreText:
+		LayoutAdd( sch, token.length );
+		break;
+
+	    case Token::Newline:
+		PadNL();
+		break;
+
+	    case Token::Tag:
+		LayoutTOKEN( token );
+		break;
+	}
+    }
+
     PadBOL();
-    AdjustPad( wsze( cl, textwidth ) );
+
+    _layout->lines    = cl;
+    _layout->padWidth = textwidth;
 
 #if 0
-    yuiDebug() << "Anchors: " << anchors.size() << std::endl;
+    yuiDebug() << "Anchors: " << _layout->anchors.size() << std::endl;
 
-    for ( unsigned i = 0; i < anchors.size(); ++i )
+    for ( unsigned i = 0; i < _layout->anchors.size(); ++i )
     {
 	yuiDebug() << form( "  %2d: [%2d,%2d] -> [%2d,%2d]",
 			    i,
-			    anchors[i].sline, anchors[i].scol,
-			    anchors[i].eline, anchors[i].ecol ) << std::endl;
+			    _layout->anchors[i].sline, _layout->anchors[i].scol,
+			    _layout->anchors[i].eline, _layout->anchors[i].ecol ) << std::endl;
     }
 #endif
 }
@@ -572,13 +754,9 @@ void NCRichText::DrawHTMLPad()
 inline void NCRichText::PadNL()
 {
     cc = cindent;
+    ++cl;
 
-    if ( ++cl == (unsigned) myPad()->height() )
-    {
-	AdjustPad( wsze( myPad()->height() + defPadSze().H, textwidth ) );
-    }
-
-    myPad()->move( cl, cc );
+    LayoutMove( cl, cc );
 
     atbol = true;
 }
@@ -602,38 +780,47 @@ inline void NCRichText::PadWS( bool tab )
     }
     else
     {
-	myPad()->addwstr( L" " );
+	LayoutAdd( L" ", 1 );
 	++cc;
     }
 }
 
 
-inline void NCRichText::PadTXT( const wchar_t * osch, const unsigned olen )
+inline void NCRichText::PadTXT( const wchar_t * sch, const unsigned len, size_t width, bool simple )
 {
-    std::wstring txt( osch, olen );
+    if ( !atbol && cc + width > textwidth )
+	PadNL();
 
-    txt = filterEntities( txt );
+    if ( simple && cc + width < textwidth )
+    {
+	// fits into the line: no need to look at each character
+	LayoutAdd( sch, len );
+	cc += width;
 
-    size_t	len = textWidth( txt );
+	if ( len )
+	    atbol = false;
 
-    if ( !atbol && cc + len > textwidth )
-	PadNL();
+	return;
+    }
 
     // insert the text
-    const wchar_t * sch = txt.data();
-
-    while ( *sch )
+    for ( const wchar_t * ech = sch + len; sch < ech; ++sch )
     {
-	myPad()->addwstr( sch, 1 );	// add one wide chararacter
-	cc += wcwidth( *sch );
+	int chwidth = NCstring::charWidth( *sch );
+
+	// a double width character that does not fit any more: Start a new
+	// line, the lines are drawn one by one and must not overflow
+	if ( !atbol && chwidth > 1 && cc + chwidth > textwidth )
+	    PadNL();
+
+	LayoutAdd( sch, 1 );	// add one wide chararacter
+	cc += chwidth;
 	atbol = false;	// at begin of line = false
 
 	if ( cc >= textwidth )
 	{
 	    PadNL();	// add a new line
 	}
-
-	sch++;
     }
 }
 
@@ -644,7 +831,7 @@ inline void NCRichText::PadTXT( const wchar_t * osch, const unsigned olen )
  * Attention: only use textWidth() to calculate space, not for iterating through a text
  * or to get the length of a text (real text length includes new lines).
  */
-size_t NCRichText::textWidth( std::wstring wstr )
+size_t NCRichText::textWidth( const std::wstring & wstr )
 {
     size_t len = 0;
     std::wstring::const_iterator wstr_it;	// iterator for std::wstring
@@ -652,13 +839,15 @@ size_t NCRichText::textWidth( std::wstring wstr )
     for ( wstr_it = wstr.begin(); wstr_it != wstr.end() ; ++wstr_it )
     {
 	// check whether char is printable
-	if ( iswprint( *wstr_it ) )
+	int chwidth = NCstring::charWidth( *wstr_it );
+
+	if ( chwidth >= 0 )
 	{
-	    len += wcwidth( *wstr_it );
+	    len += chwidth;
 	}
 	else if ( *wstr_it == '\t' )
 	{
-	    len += myPad()->tabsize();
+	    len += NCursesWindow::tabsize();
 	}
     }
 
@@ -667,24 +856,24 @@ size_t NCRichText::textWidth( std::wstring wstr )
 
 
 /**
- * Set character attributes (e.g. color, font face...)
+ * Get character attributes (e.g. color, font face...)
  **/
-inline void NCRichText::PadSetAttr()
+chtype NCRichText::textAttr( unsigned tattr ) const
 {
     const NCstyle::StRichtext & style( wStyle().richtext );
     chtype nbg = style.plain;
 
-    if ( Tattr & T_ANC )
+    if ( tattr & T_ANC )
     {
 	nbg = style.link;
     }
-    else if ( Tattr & T_HEAD )
+    else if ( tattr & T_HEAD )
     {
 	nbg = style.title;
     }
     else
     {
-	switch ( Tattr & Tfontmask )
+	switch ( tattr & Tfontmask )
 	{
 	    case T_BOLD:
 		nbg = style.B;
@@ -716,7 +905,7 @@ inline void NCRichText::PadSetAttr()
 	}
     }
 
-    myPad()->bkgdset( nbg );
+    return nbg;
 }
 
 
@@ -730,7 +919,7 @@ void NCRichText::PadSetLevel()
     if ( atbol )
     {
 	cc = cindent;
-	myPad()->move( cl, cc );
+	LayoutMove( cl, cc );
     }
 }
 
@@ -751,10 +940,8 @@ void NCRichText::PadChangeLevel( bool down, int tag )
 }
 
 
-void NCRichText::openAnchor( std::wstring args )
+std::wstring NCRichText::anchorTarget( std::wstring args )
 {
-    canchor.open( cl, cc );
-
     const wchar_t * ch = ( wchar_t * )args.data();
     const wchar_t * lookupstr = L"href = ";
     const wchar_t * lookup = lookupstr;
@@ -805,12 +992,19 @@ void NCRichText::openAnchor( std::wstring args )
 	if ( end != std::wstring::npos )
 	    args.erase( end );
 
-	canchor.target = args;
-    }
-    else
-    {
-	yuiError() << "No value for 'HREF=' in anchor '" << args << "'" << std::endl;
+	return args;
     }
+
+    yuiError() << "No value for 'HREF=' in anchor '" << args << "'" << std::endl;
+
+    return std::wstring();
+}
+
+
+void NCRichText::openAnchor( const std::wstring & target )
+{
+    canchor.open( cl, cc );
+    canchor.target = target;
 }
 
 
@@ -819,14 +1013,14 @@ void NCRichText::closeAnchor()
     canchor.close( cl, cc );
 
     if ( canchor.valid() )
-	anchors.push_back( canchor );
+	_layout->anchors.push_back( canchor );
 
     canchor = Anchor();
 }
 
 
 // expect "<[/]value>"
-bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
+bool NCRichText::ParseTOKEN( const wchar_t * sch, const wchar_t *& ech )
 {
     // "<[/]value>"
     if ( *sch++ != L'<' || *( ech - 1 ) != L'>' )
@@ -949,10 +1143,42 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
     if ( token == T_IGNORE )
 	return true;
 
+    AddToken( Token::Tag );
+
+    Token & tag = _tokens.back();
+    tag.tag    = token;
+    tag.endtag = endtag;
+    tag.param  = ( token == T_HEAD ? headinglevel : leveltag );
+
+    if ( token == T_PLAIN )
+    {
+	preTag = !endtag;	// display text preserving newlines and spaces
+
+	if ( preTag )
+	    tag.param = PreWidth( ech );
+    }
+    else if ( token == T_ANC && !endtag )
+    {
+	std::wstring target = anchorTarget( args );
+
+	tag.start  = _tokenText.size();
+	tag.length = target.size();
+	_tokenText += target;
+    }
+
+    return true;
+}
+
+
+void NCRichText::LayoutTOKEN( const Token & tag )
+{
+    TOKEN token = (TOKEN) tag.tag;
+    bool endtag = tag.endtag;
+
     switch ( token )
     {
 	case T_LEVEL:
-	    PadChangeLevel( endtag, leveltag );
+	    PadChangeLevel( endtag, tag.param );
 	    PadBOL();
 	    // add new line after end of the list
             // (only at the very end)
@@ -972,10 +1198,9 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
 	    else
 		Tattr |= token;
 
-	    PadSetAttr();
 	    PadBOL();
 
-	    if ( headinglevel && endtag )
+	    if ( tag.param && endtag )
 		PadNL();
 
 	    break;
@@ -998,11 +1223,11 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
 
 	    if ( !endtag )
 	    {
-		std::wstring tag;
+		std::wstring listtag;
 
 		if ( liststack.empty() )
 		{
-		    tag = std::wstring( listindent, L' ' );
+		    listtag = std::wstring( listindent, L' ' );
 		}
 		else
 		{
@@ -1017,15 +1242,15 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
 			swprintf( buf, 15, L" %lc  ", listleveltags[liststack.size()%listleveltags.size()] );
 		    }
 
-		    tag = buf;
+		    listtag = buf;
 		}
 
 		// outsent list tag:
-		cc = ( tag.size() < cc ? cc - tag.size() : 0 );
+		cc = ( listtag.size() < cc ? cc - listtag.size() : 0 );
 
-		myPad()->move( cl, cc );
+		LayoutMove( cl, cc );
 
-		PadTXT( tag.c_str(), tag.size() );
+		PadTXT( listtag.c_str(), listtag.size(), textWidth( listtag ), true );
 
 		atbol = true;
 	    }
@@ -1036,12 +1261,12 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
 
 	    if ( !endtag )
 	    {
-		preTag = true;	// display text preserving newlines and spaces
-		AdjustPrePad( ech );
+		// widen the pad for the longest line
+		if ( tag.param > textwidth )
+		    textwidth = tag.param;
 	    }
 	    else
 	    {
-		preTag = false;
 		PadNL();	 // add new line (text may continue after </pre>)
 	    }
 
@@ -1055,7 +1280,7 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
 	    }
 	    else
 	    {
-		openAnchor( args );
+		openAnchor( std::wstring( _tokenText, tag.start, tag.length ) );
 	    }
 
 	    // fall through
@@ -1068,16 +1293,12 @@ bool NCRichText::PadTOKEN( const wchar_t * sch, const wchar_t *& ech )
 	    else
 		Tattr |= token;
 
-	    PadSetAttr();
-
 	    break;
 
 	case T_IGNORE:
 	case T_UNKNOWN:
 	    break;
     }
-
-    return true;
 }
 
 
@@ -1091,29 +1312,21 @@ void NCRichText::arm( unsigned i )
 
     // yuiDebug() << i << " (" << armed << ")" << std::endl;
 
+    // The anchors are highlighted by drawLine(), so this only needs to
+    // update the pad.
+
     if ( i == armed )
     {
 	if ( armed != Anchor::unset )
-	{
-	    // just redraw
-	    anchors[armed].draw( *myPad(), wStyle().richtext.getArmed( GetState() ), 0 );
-	    myPad()->update();
-	}
+	    myPad()->update(); // just redraw
 
 	return;
     }
 
     if ( armed != Anchor::unset )
-    {
-	anchors[armed].draw( *myPad(), wStyle().richtext.link, (int) wStyle().richtext.visitedlink );
-	armed = Anchor::unset;
-    }
+	visitedAnchors.insert( armed );
 
-    if ( i != Anchor::unset )
-    {
-	armed = i;
-	anchors[armed].draw( *myPad(), wStyle().richtext.getArmed( GetState() ), 0 );
-    }
+    armed = i;
 
     if ( showLinkTarget )
     {
@@ -1317,7 +1530,7 @@ void NCRichText::setVScrollValue( const std::string & newValue )
     if ( newValue == "minimum" )
 	mypad->ScrlLine( 0 );
     else if ( newValue == "maximum" )
-	mypad->ScrlLine( mypad->maxy() );
+	mypad->ScrlToLastLine();
     else
     {
 	try
@@ -26,7 +26,10 @@
 #define NCRichText_h
 
 #include <iosfwd>
+#include <list>
+#include <set>
 #include <stack>
+#include <vector>
 
 #include <yui/YRichText.h>
 #include "NCPadWidget.h"
@@ -66,6 +69,7 @@ private:
 
     bool plainText;
 
+    // layout state, see LayoutHTML()
     unsigned textwidth;
     unsigned cl;
     unsigned cc;
@@ -103,7 +107,7 @@ private:
 
     void PadChangeLevel( bool down, int tag );
     void PadSetLevel();
-    size_t textWidth( std::wstring wstr );
+    static size_t textWidth( const std::wstring & wstr );
 
 private:
 
@@ -163,7 +167,11 @@ private:
 	    return sline < nextinvisible && eline >= firstvisible;
 	}
 
-	void draw( NCPad & pad, const chtype attr, int color );
+	/**
+	 * Change the attributes of the part of the anchor that is in text
+	 * line 'line', drawn in row 'row' of 'w'.
+	 **/
+	void draw( NCursesWindow & w, int row, unsigned line, const chtype attr, int color );
     };
 
     static const bool showLinkTarget;
@@ -171,11 +179,13 @@ private:
     Anchor		canchor;
     std::vector<Anchor>	anchors;
     unsigned		armed;
+    std::set<unsigned>	visitedAnchors;	// drawn as visited links
 
     unsigned vScrollFirstvisible;
     unsigned vScrollNextinvisible;
 
-    void openAnchor( std::wstring args );
+    static std::wstring anchorTarget( std::wstring args );
+    void openAnchor( const std::wstring & target );
     void closeAnchor();
 
     void arm( unsigned i );
@@ -183,18 +193,103 @@ private:
 
 private:
 
-    void PadSetAttr();
+    /**
+     * One piece of the parsed HTML text: A word, a blank, a tag or a piece
+     * of <pre> text. Parsing does not depend on the width, so this is done
+     * only once for each text in ParseHTML(). The (entity filtered) texts
+     * are in _tokenText.
+     **/
+    struct Token
+    {
+	enum Type { Space, Word, PreText, Newline, Tag };
+
+	unsigned char  type;
+	bool	       endtag;	// Tag: </...>
+	bool	       simple;	// Word: only printable characters, no tabs
+	unsigned short tag;	// Tag: TOKEN
+	unsigned       start;	// Word, PreText, anchor target: offset in _tokenText
+	unsigned       length;
+	unsigned       param;	// Word: columns; <pre>: longest line;
+				// list and heading level
+    };
+
+    /**
+     * The texts of the parsed HTML in screen lines for one width.
+     *
+     * The layout is a list of segments, each starting at a position in the
+     * pad and continuing with text pieces that are added one after the
+     * other, each with its own text attributes (Tattr).
+     **/
+    struct Layout
+    {
+	struct Piece
+	{
+	    unsigned attr;	// Tattr
+	    unsigned end;	// end offset in 'text'
+	};
+
+	struct Segment
+	{
+	    unsigned line;
+	    unsigned col;
+	    unsigned firstPiece;
+	};
+
+	unsigned		width;		// the width it was made for
+	unsigned		padWidth;	// can be wider because of <pre>
+	unsigned		lines;
+	std::wstring		text;
+	std::vector<Piece>	pieces;
+	std::vector<Segment>	segments;
+	std::vector<Anchor>	anchors;
+	std::vector<unsigned>	lineSegment;	// first segment of each line
+
+	Layout( unsigned w = 0 ) : width( w ), padWidth( w ), lines( 0 ) {}
+    };
+
+    std::vector<Token>	_tokens;
+    std::wstring	_tokenText;
+    std::list<Layout>	_layouts;	// cache, most recently used first
+    Layout *		_layout;	// the one being built or drawn
+
+    void ParseHTML();
+    bool ParseTOKEN( const wchar_t * sch, const wchar_t *& ech );
+    void AddToken( Token::Type type, const std::wstring & txt = std::wstring() );
+    size_t PreWidth( const wchar_t * sch );
 
-    void DrawPlainPad();
-    void DrawHTMLPad();
+    /**
+     * Return the layout for 'width' from the cache or create it.
+     **/
+    const Layout & layoutFor( unsigned width );
+
+    /**
+     * Drop the cached layouts, e.g. after the text changed.
+     **/
+    void clearLayouts();
+
+    void LayoutPlain();
+    void LayoutHTML();
+    void LayoutTOKEN( const Token & token );
+
+    void LayoutMove( unsigned line, unsigned col );
+    void LayoutAdd( const wchar_t * sch, size_t len );
+
+    /**
+     * Return the character attributes (color, font face...) for 'tattr'.
+     **/
+    chtype textAttr( unsigned tattr ) const;
+
+    /**
+     * Draw text line 'lineNo' of the current layout into row 'row' of 'w'.
+     * This is the NCVirtualPad::LineDrawer of the pad: Only the visible
+     * lines are drawn, see NCPad::paging().
+     **/
+    void drawLine( NCursesWindow & w, int row, unsigned lineNo );
 
     void PadNL();
     void PadBOL();
     void PadWS( bool tab = false );
-    void PadTXT( const wchar_t * sch, const unsigned len );
-    void PadPreTXT( const wchar_t * sch, const unsigned len );
-    void AdjustPrePad( const wchar_t * sch );
-    bool PadTOKEN( const wchar_t * sch, const wchar_t *& ech );
+    void PadTXT( const wchar_t * sch, const unsigned len, size_t width, bool simple );
 
 protected:
 
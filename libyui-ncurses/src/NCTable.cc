@@ -31,6 +31,7 @@
 
 #include <yui/YMenuButton.h>
 #include <yui/YTypes.h>
+#include <algorithm>
 
 using std::string;
 using std::vector;
@@ -67,7 +68,9 @@ NCTable::NCTable( YWidget *      parent,
     , _multiSelect( multiSelection )
     , _lastSortCol( 0 )
     , _sortReverse( false )
+    , _itemsSorted( false )
     , _sortStrategy( new NCTableSortDefault() )
+    , _searchCol( 0 )
 {
     // yuiDebug() << endl;
 
@@ -107,6 +110,7 @@ void NCTable::rebuildHeaderLine()
     }
 
     hasHeadline = myPad()->SetHeadline( headers );
+    myPad()->SetSearchCol( _prefixCols + _searchCol );
 }
 
 
@@ -162,11 +166,18 @@ void NCTable::cellChanged( const YTableCell * changedCell )
     NCTableLine * tableLine = (NCTableLine *) ytableItem->data();
     YUI_CHECK_PTR( tableLine );
 
+    // Let the pad know that the column width might change
+    myPad()->ModifyLine( tableLine->index() );
+
     NCTableCol * tableCol = tableLine->GetCol( changedCell->column() );
 
     if ( tableCol )
     {
         tableCol->SetLabel( changedCell->label() );
+
+        if ( _itemsSorted && ! keepSorting() && changedCell->column() == _lastSortCol )
+            resortItem( ytableItem );
+
         DrawPad();
     }
     else
@@ -232,6 +243,8 @@ void NCTable::addItems( const YItemCollection & itemCollection )
 void NCTable::addItem( YItem *            yitem,
                        NCTableLine::STATE state )
 {
+    _itemsSorted = false;               // the new item is just appended
+
     if ( ! yitem->parent() )            // Only for toplevel items:
         YTable::addItem( yitem );       // Notify the YTable base class
 
@@ -246,6 +259,8 @@ void NCTable::addItem( YItem *            yitem,
                        bool               preventRedraw,
                        NCTableLine::STATE state )
 {
+    _itemsSorted = false;               // the new item is just appended
+
     if ( ! yitem->parent() )            // Only for toplevel items:
         YTable::addItem( yitem );       // Notify the YTable base class
 
@@ -359,6 +374,7 @@ void NCTable::deleteAllItems()
     _nestedItems   = false;
     _lastSortCol   = 0;
     _sortReverse   = false;
+    _itemsSorted   = false;
 }
 
 
@@ -730,6 +746,7 @@ void NCTable::sortItems( int sortCol, bool reverse )
     _lastSortCol = sortCol;
 
     sortYItems( itemsBegin(), itemsEnd() );
+    _itemsSorted = true;
 
     rebuildPadLines();
 }
@@ -752,6 +769,35 @@ void NCTable::sortYItems( YItemIterator begin,
 }
 
 
+void NCTable::resortItem( YItem * item )
+{
+    // Only move this one item instead of sorting the whole table again
+
+    YItem * parent = item->parent();
+    YItemIterator begin = parent ? parent->childrenBegin() : itemsBegin();
+    YItemIterator end   = parent ? parent->childrenEnd()   : itemsEnd();
+    YItemIterator it    = std::find( begin, end, item );
+
+    if ( ! _sortStrategy->resort( begin, end, it ) )
+        return;
+
+    // Move its pad line before the line of the item that now follows it
+
+    it = std::find( begin, end, item );
+    YItem * next = it + 1 != end ? *( it + 1 ) : 0;
+
+    myPad()->MoveLine( (NCTableLine *) item->data(),
+                       next ? (NCTableLine *) next->data() : 0 );
+}
+
+
+void NCTable::setSearchColumn( int column )
+{
+    _searchCol = column;
+    myPad()->SetSearchCol( _prefixCols + _searchCol );
+}
+
+
 void NCTable::setSortStrategy( NCTableSortStrategyBase * newStrategy )
 {
     if ( _sortStrategy )
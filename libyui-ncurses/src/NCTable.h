@@ -265,6 +265,18 @@ public:
      **/
     NCTableSortStrategyBase * sortStrategy() const { return _sortStrategy; }
 
+    /**
+     * Set the column for the type-ahead search (default: 0). Typing the
+     * first characters of an item's text in that column moves the cursor
+     * to that item.
+     **/
+    void setSearchColumn( int column );
+
+    /**
+     * Return the column for the type-ahead search.
+     **/
+    int searchColumn() const { return _searchCol; }
+
 
 protected:
 
@@ -431,6 +443,13 @@ protected:
     void sortYItems( YItemIterator begin,
                      YItemIterator end   );
 
+    /**
+     * Move 'item' to its sort position after its cell in the sort column
+     * changed. The other items keep their order, and only the pad line of
+     * 'item' is moved; all NCTableLines remain valid.
+     **/
+    void resortItem( YItem * item );
+
 private:
 
     // Disable unwanted assignment opearator and copy constructor
@@ -453,7 +472,10 @@ private:
 
     int  _lastSortCol;
     bool _sortReverse;
+    bool _itemsSorted;      // were the items sorted since the last addItem()?
     NCTableSortStrategyBase * _sortStrategy;    //< owned
+
+    int  _searchCol;
 };
 
 
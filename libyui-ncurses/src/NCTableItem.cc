@@ -316,6 +316,23 @@ void NCTableLine::UpdateFormat( NCTableStyle & tableStyle )
 }
 
 
+bool NCTableLine::RemoveFormat( NCTableStyle & tableStyle ) const
+{
+    bool ok = true;
+
+    for ( unsigned col = 0; col < Cols(); ++col )
+    {
+	if ( !_cells[ col ] )
+	    continue;
+
+	if ( ! tableStyle.LessColWidth( col, _cells[ col ]->Size().W ) )
+	    ok = false;
+    }
+
+    return ok;
+}
+
+
 void NCTableLine::DrawAt( NCursesWindow & w,
                           const wrect     at,
 			  NCTableStyle &  tableStyle,
@@ -414,7 +431,7 @@ void NCTableLine::updatePrefix()
     _prefix = new chtype[ prefixLen() ];
     chtype * tagend = &_prefix[ prefixLen()-1 ];
     *tagend-- = ACS_HLINE;
-    *tagend-- = firstChild() ? ACS_TTEE : ACS_HLINE;
+    *tagend-- = hasChildren() ? ACS_TTEE : ACS_HLINE;
 
     if ( _parent )
     {
@@ -455,14 +472,14 @@ void NCTableLine::drawPrefix( NCursesWindow & w,
 
     w.move( at.Pos.L, at.Pos.C + prefixLen() - 2 );
 
-    if ( firstChild() && !isSpecial() )
+    if ( hasChildren() && !isSpecial() )
     {
         w.bkgdset( tableStyle.highlightBG( _vstate,
                                            NCTableCol::HINT,
                                            NCTableCol::SEPARATOR ) );
     }
 
-    if ( firstChild() && !firstChild()->isVisible() )
+    if ( hasChildren() && !isBranchOpen() )
         w.addch( '+' );
     else
         w.addch( _prefix[ prefixLen() - 2 ] );
@@ -514,6 +531,9 @@ bool NCTableLine::handleInput( wint_t key )
 
 void NCTableLine::openBranch()
 {
+    if ( hasChildren() )
+        createChildLines();
+
     if ( firstChild() && ! firstChild()->isVisible() )
     {
         // YTableItem inherits YTreeItem which inherits YItem,
@@ -554,9 +574,9 @@ void NCTableLine::closeBranch()
 
 void NCTableLine::toggleOpenClosedState()
 {
-    if ( firstChild() )
+    if ( hasChildren() )
     {
-        if ( firstChild()->isVisible() )
+        if ( isBranchOpen() )
             closeBranch();
         else
             openBranch();
@@ -710,6 +730,7 @@ NCTableStyle::NCTableStyle( const NCWidget & parentWidget )
     : _parentWidget( parentWidget )
     , _headline( 0 )
     , _colWidth( 0 )
+    , _colWidthCount( 0 )
     , _colAdjust( 0 )
     , _colSepWidth( 1 )
     , _colSepChar( ACS_VLINE )
@@ -726,6 +747,7 @@ bool NCTableStyle::SetStyleFrom( const std::vector<NCstring> & head )
     _headline.SetCols( ncols );
 
     _colWidth.clear();
+    _colWidthCount.clear();
     _colAdjust.clear();
     AssertMinCols( ncols );
 
@@ -215,7 +215,7 @@ public:
     virtual void setNested( bool val ) { _nested = val; }
 
     /**
-     * Open this tree branch
+     * Open this tree branch. This creates the child lines first if needed.
      **/
     void openBranch();
 
@@ -254,6 +254,13 @@ public:
      **/
     virtual void UpdateFormat( NCTableStyle & tableStyle );
 
+    /**
+     * Remove this line from TableStyle before it is deleted or modified.
+     * Return 'false' if a column might get narrower, i.e. the column widths
+     * need to be recalculated from all lines.
+     **/
+    bool RemoveFormat( NCTableStyle & tableStyle ) const;
+
     /**
      * Create the real tree hierarchy line graphics prefix and store it in
      * _prefix
@@ -277,6 +284,18 @@ public:
     virtual NCTableLine * firstChild()  const { return _firstChild;  }
     virtual NCTableLine * nextSibling() const { return _nextSibling; }
 
+    /**
+     * Return 'true' if this line has children, even if their lines are not
+     * created yet.
+     **/
+    virtual bool hasChildren() const { return _firstChild; }
+
+    /**
+     * Return 'true' if this is an open branch, i.e. the child lines exist
+     * and are not hidden.
+     **/
+    bool isBranchOpen() const { return firstChild() && ! firstChild()->isHidden(); }
+
     void setParent     ( NCTableLine * newVal ) { _parent      = newVal; }
     void setFirstChild ( NCTableLine * newVal ) { _firstChild  = newVal; }
     void setNextSibling( NCTableLine * newVal ) { _nextSibling = newVal; }
@@ -325,6 +344,16 @@ protected:
      **/
     void addToTree( NCTableLine * parent );
 
+    /**
+     * Create the lines for the children if they do not exist yet. This is
+     * called before the branch is opened.
+     *
+     * This default implementation does nothing: The child lines of a table
+     * are all created in advance. Derived classes that create them on
+     * demand need to overwrite this.
+     **/
+    virtual void createChildLines() {}
+
     /**
      * Return 'true' if yitem inherits YTreeItem or YTableItem and has its
      * 'open' flag set to 'true'.
@@ -552,6 +581,7 @@ public:
     void ResetToMinCols()
     {
 	_colWidth.clear();
+	_colWidthCount.clear();
 	AssertMinCols( _headline.Cols() );
 	_headline.UpdateFormat( *this );
     }
@@ -562,6 +592,7 @@ public:
 	if ( _colWidth.size() < num )
 	{
 	    _colWidth.resize( num, 0 );
+	    _colWidthCount.resize( num, 0 );
 	    _colAdjust.resize( _colWidth.size(), NC::LEFT );
 	}
     }
@@ -571,10 +602,36 @@ public:
     /// @param val width of that column for some line
     void MinColWidth( unsigned num, unsigned val )
     {
-	AssertMinCols( num );
+	AssertMinCols( num + 1 );
 
 	if ( val > _colWidth[num] )
-	    _colWidth[ num ] = val;
+	{
+	    _colWidth[ num ]      = val;
+	    _colWidthCount[ num ] = 1;
+	}
+	else if ( val == _colWidth[num] && val > 0 )
+	{
+	    ++_colWidthCount[ num ];
+	}
+    }
+
+    /// Undo a MinColWidth() call for a line that is removed or modified.
+    /// @param num column number
+    /// @param val width of that column for that line
+    /// @return false if the column might get narrower now, i.e. the widths
+    ///   need to be recalculated from all lines with ResetToMinCols()
+    bool LessColWidth( unsigned num, unsigned val )
+    {
+	if ( val == 0 )
+	    return true;
+
+	if ( num >= Cols() || val > _colWidth[num] )
+	    return false;
+
+	if ( val == _colWidth[num] )
+	    return --_colWidthCount[ num ] > 0;
+
+	return true;
     }
 
     NC::ADJUST ColAdjust( unsigned num ) const { return _colAdjust[num]; }
@@ -628,6 +685,7 @@ private:
     const NCWidget &            _parentWidget;
     NCTableHead                 _headline;
     std::vector<unsigned>	_colWidth;  ///< column widths
+    std::vector<unsigned>	_colWidthCount; ///< number of cells with that width
     std::vector<NC::ADJUST>	_colAdjust; ///< column alignment
 
 
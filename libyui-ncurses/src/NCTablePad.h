@@ -127,8 +127,6 @@ protected:
      **/
     virtual int  DoRedraw();
 
-    virtual void directDraw( NCursesWindow & w, const wrect at, unsigned lineno );
-
 
 private:
 
@@ -23,12 +23,19 @@
 
 /-*/
 
+#include <algorithm>
+
 #define  YUILogComponent "ncurses"
 #include <yui/YUILog.h>
 #include "NCTablePadBase.h"
 
 using std::vector;
 
+// Tables and trees with more visible lines are paged: The pad only has the
+// size of the viewport and the lines are drawn on demand, so the memory
+// usage does not depend on the number of lines.
+#define MAX_TABLE_PAD_HEIGHT 1024
+
 
 NCTablePadBase::NCTablePadBase( int lines, int cols, const NCWidget & p )
     : NCPad( lines, cols, p )
@@ -36,9 +43,13 @@ NCTablePadBase::NCTablePadBase( int lines, int cols, const NCWidget & p )
     , _headpad( 1, 1 )
     , _dirtyHead( false )
     , _dirtyFormat( false )
+    , _dirtyWidths( true )
+    , _dirtyVisibleItems( true )
+    , _dirtyLinePos( false )
     , _itemStyle( p )
     , _citem( 0 )
 {
+    setMaxPadHeight( MAX_TABLE_PAD_HEIGHT );
 }
 
 
@@ -55,28 +66,26 @@ void NCTablePadBase::ClearTable()
 
     _items.clear();
     _visibleItems.clear();
-    setFormatDirty();
+    _unformattedLines.clear();
+    _linePos.clear();
+    _dirtyLinePos = false;
+    _dirtyVisibleItems = true;
+    _search.invalidate();
+    setWidthsDirty();
 }
 
 
 NCTableLine * NCTablePadBase::getLineWithIndex( unsigned idx ) const
 {
-    NCTableLine * line = 0;
-
-    if ( idx < Lines() )
-	line = _items[ idx ];
+    // Unless the table was sorted, the index is the position
 
-    if ( (unsigned) line->index() == idx )
-        return line;
+    if ( idx < Lines() && (unsigned) _items[ idx ]->index() == idx )
+        return _items[ idx ];
 
     int pos = findIndex( idx );
 
     if ( pos >= 0 )
-    {
-        yuiWarning() << "Found item with index " << idx << " at pos " << pos << endl;
-
         return _items[ pos ];
-    }
 
     yuiError() << "Can't find item with index " << idx << endl;
 
@@ -92,20 +101,148 @@ const NCTableLine * NCTablePadBase::GetLine( unsigned idx ) const
 
 NCTableLine * NCTablePadBase::ModifyLine( unsigned idx )
 {
+    NCTableLine * line = getLineWithIndex( idx );
+
+    if ( line )
+    {
+        // The caller may change any cell: Take the line out of the column
+        // widths now and add it again in the next UpdateFormat()
+        forgetLineFormat( line );
+        _unformattedLines.insert( line );
+        _search.lineModified( line );
+    }
+
     setFormatDirty();
-    return getLineWithIndex( idx );
+    return line;
+}
+
+
+void NCTablePadBase::forgetLineFormat( NCTableLine * line )
+{
+    // A line that was not formatted yet does not contribute to the widths
+    if ( _unformattedLines.erase( line ) > 0 )
+        return;
+
+    if ( ! _dirtyWidths && ! line->RemoveFormat( _itemStyle ) )
+        setWidthsDirty(); // a widest cell is gone
+}
+
+
+void NCTablePadBase::MoveLine( NCTableLine * line, NCTableLine * before )
+{
+    if ( ! line || line == before )
+        return;
+
+    NCTableLine * current = GetCurrentLine();
+    NCTableLine * parent  = line->parent();
+
+    // The order of the toplevel lines in _items is their display order; the
+    // child lines are displayed in the order of their sibling links.
+
+    auto it = std::find( _items.begin(), _items.end(), line );
+
+    if ( it == _items.end() )
+        return;
+
+    _items.erase( it );
+    _items.insert( before ? std::find( _items.begin(), _items.end(), before ) : _items.end(),
+                   line );
+
+    if ( parent )
+    {
+        // Unlink 'line' from its siblings
+
+        NCTableLine * oldPrev = 0;
+
+        if ( parent->firstChild() == line )
+            parent->setFirstChild( line->nextSibling() );
+        else
+        {
+            oldPrev = parent->firstChild();
+
+            while ( oldPrev->nextSibling() != line )
+                oldPrev = oldPrev->nextSibling();
+
+            oldPrev->setNextSibling( line->nextSibling() );
+        }
+
+        // Link it again before 'before'
+
+        NCTableLine * newPrev = 0;
+
+        if ( parent->firstChild() == before )
+            parent->setFirstChild( line );
+        else
+        {
+            newPrev = parent->firstChild();
+
+            while ( newPrev->nextSibling() != before )
+                newPrev = newPrev->nextSibling();
+
+            newPrev->setNextSibling( line );
+        }
+
+        line->setNextSibling( before );
+
+        // Only the lines whose next sibling changed need new line graphics
+        updatePrefixes( line );
+
+        if ( oldPrev )
+            updatePrefixes( oldPrev );
+
+        if ( newPrev && newPrev != oldPrev )
+            updatePrefixes( newPrev );
+    }
+
+    _dirtyLinePos      = true;
+    _dirtyVisibleItems = true;
+    setFormatDirty();
+
+    if ( current )
+    {
+        updateVisibleItems();
+        auto pos = std::find( _visibleItems.begin(), _visibleItems.end(), current );
+
+        if ( pos != _visibleItems.end() )
+            ScrlLine( pos - _visibleItems.begin() );
+    }
+}
+
+
+void NCTablePadBase::updatePrefixes( NCTableLine * line )
+{
+    if ( line->prefixLen() > 0 )
+        line->updatePrefix();
+
+    for ( NCTableLine * child = line->firstChild(); child; child = child->nextSibling() )
+        updatePrefixes( child );
 }
 
 
 int NCTablePadBase::findIndex( unsigned idx ) const
 {
-    for ( unsigned i=0; i < Lines(); i++ )
+    if ( _dirtyLinePos )
+        updateLinePos();
+
+    auto it = _linePos.find( idx );
+
+    return it != _linePos.end() ? (int) it->second : -1;
+}
+
+
+void NCTablePadBase::updateLinePos() const
+{
+    _linePos.clear();
+    _linePos.reserve( Lines() );
+
+    // Like a linear search, find the first line with an index
+    for ( unsigned i = 0; i < Lines(); ++i )
     {
-        if ( (unsigned) _items[ i ]->index() == idx )
-            return i;
+        if ( _items[ i ]->index() >= 0 )
+            _linePos.emplace( _items[ i ]->index(), i );
     }
 
-    return -1;
+    _dirtyLinePos = false;
 }
 
 
@@ -120,8 +257,11 @@ void NCTablePadBase::SetLines( unsigned idx )
     {
 	for ( unsigned i = idx; i < Lines(); ++i )
 	{
+	    forgetLineFormat( _items[i] );
 	    delete _items[i];
 	}
+
+	_dirtyLinePos = true;
     }
 
     _items.resize( idx, 0 );
@@ -129,9 +269,13 @@ void NCTablePadBase::SetLines( unsigned idx )
     for ( unsigned i = olines; i < Lines(); ++i )
     {
 	if ( !_items[i] )
+	{
 	    _items[i] = new NCTableLine( 0 );
+	    _unformattedLines.insert( _items[i] );
+	}
     }
 
+    _dirtyVisibleItems = true;
     setFormatDirty();
 }
 
@@ -147,16 +291,37 @@ void NCTablePadBase::SetLines( std::vector<NCTableLine*> & newItems )
 	    _items[i] = new NCTableLine( 0 );
     }
 
-    setFormatDirty();
+    _dirtyLinePos = true;
+    _dirtyVisibleItems = true;
+    setWidthsDirty();
 }
 
 
 void NCTablePadBase::AddLine( unsigned idx, NCTableLine * item )
 {
     assertLine( idx );
+
+    // Replacing a line with an index (not just an empty placeholder line)
+    // might uncover another line with the same index
+    if ( _items[idx]->index() >= 0 )
+        _dirtyLinePos = true;
+
+    forgetLineFormat( _items[idx] );
     delete _items[idx];
     _items[idx] = item ? item : new NCTableLine( 0 );
+    _unformattedLines.insert( _items[idx] );
+
+    int index = _items[idx]->index();
+
+    if ( index >= 0 && ! _dirtyLinePos )
+    {
+        auto result = _linePos.emplace( index, idx );
+
+        if ( ! result.second && result.first->second > idx )
+            result.first->second = idx;
+    }
 
+    _dirtyVisibleItems = true;
     setFormatDirty();
 }
 
@@ -171,7 +336,7 @@ void NCTablePadBase::assertLine( unsigned idx )
 bool NCTablePadBase::SetHeadline( const vector<NCstring> & head )
 {
     bool hascontent = _itemStyle.SetStyleFrom( head );
-    setFormatDirty();
+    setWidthsDirty();
     update();
 
     return hascontent;
@@ -180,7 +345,7 @@ bool NCTablePadBase::SetHeadline( const vector<NCstring> & head )
 
 void NCTablePadBase::wRecoded()
 {
-    setFormatDirty();
+    setWidthsDirty();
     update();
 }
 
@@ -204,11 +369,25 @@ wsze NCTablePadBase::tableSize()
 wsze NCTablePadBase::UpdateFormat()
 {
     dirty = true;
-    _itemStyle.ResetToMinCols();
 
-    for ( unsigned i = 0; i < Lines(); ++i )
-	_items[i]->UpdateFormat( _itemStyle );
+    if ( _dirtyWidths )
+    {
+        _itemStyle.ResetToMinCols();
+
+        for ( unsigned i = 0; i < Lines(); ++i )
+            _items[i]->UpdateFormat( _itemStyle );
+    }
+    else
+    {
+        // Only the lines added or modified since the last call can make
+        // columns wider; narrower columns set _dirtyWidths.
+
+        for ( NCTableLine * line : _unformattedLines )
+            line->UpdateFormat( _itemStyle );
+    }
 
+    _unformattedLines.clear();
+    _dirtyWidths = false;
     _dirtyFormat = false;
     updateVisibleItems();
 
@@ -226,12 +405,61 @@ wsze NCTablePadBase::UpdateFormat()
 
 void NCTablePadBase::updateVisibleItems()
 {
+    if ( ! _dirtyVisibleItems )
+        return;
+
     _visibleItems.clear();
 
+    // Child lines may have been created after other toplevel lines (NCTree
+    // creates them only when a branch is opened), so follow the tree links
+    // instead of the order of _items.
+
     for ( unsigned i = 0; i < Lines(); ++i )
     {
-	if ( _items[ i ]->isVisible() )
+	if ( ! _items[ i ]->parent() )
+	{
 	    _visibleItems.push_back( _items[ i ] );
+	    addVisibleChildren( _items[ i ], _visibleItems );
+	}
+    }
+
+    _dirtyVisibleItems = false;
+    _search.invalidate();
+}
+
+
+void NCTablePadBase::updateVisibleBranch( int lineNo )
+{
+    NCTableLine * line = _visibleItems[ lineNo ];
+
+    // The lines of the old branch are the ones following it with a deeper
+    // tree level
+
+    auto begin = _visibleItems.begin() + lineNo + 1;
+    auto end   = begin;
+
+    while ( end != _visibleItems.end() && (*end)->treeLevel() > line->treeLevel() )
+	++end;
+
+    begin = _visibleItems.erase( begin, end );
+
+    std::vector<NCTableLine*> children;
+    addVisibleChildren( line, children );
+    _visibleItems.insert( begin, children.begin(), children.end() );
+    _search.invalidate();
+}
+
+
+void NCTablePadBase::addVisibleChildren( const NCTableLine * line,
+                                         std::vector<NCTableLine*> & lines ) const
+{
+    for ( NCTableLine * child = line->firstChild(); child; child = child->nextSibling() )
+    {
+	if ( ! child->isHidden() )
+	{
+	    lines.push_back( child );
+	    addVisibleChildren( child, lines );
+	}
     }
 }
 
@@ -270,6 +498,9 @@ void NCTablePadBase::prepareRedraw()
 
 void NCTablePadBase::drawContentLines()
 {
+    if ( paging() )
+        return; // drawn by directDraw() in update()
+
     wsze lineSize( 1, width() );
 
     for ( unsigned lineNo = 0; lineNo < visibleLines(); ++lineNo )
@@ -282,6 +513,20 @@ void NCTablePadBase::drawContentLines()
 }
 
 
+void NCTablePadBase::directDraw( NCursesWindow & w, const wrect at, unsigned lineNo )
+{
+    if ( lineNo < visibleLines() )
+    {
+        _visibleItems[ lineNo ]->DrawAt( w,
+                                         at,
+                                         _itemStyle,
+                                         ( (unsigned) currentLineNo() == lineNo ) );
+    }
+    else
+        yuiWarning() << "Illegal Line no " << lineNo << " (" << visibleLines() << ")" << std::endl;
+}
+
+
 void NCTablePadBase::drawHeader()
 {
     wsze lineSize( 1, width() );
@@ -417,10 +662,45 @@ bool NCTablePadBase::handleInput( wint_t key )
         }
     }
 
+    if ( handled )
+        _search.reset(); // e.g. cursor movement: start a new search next time
+    else
+        handled = searchHandleInput( key );
+
     return handled;
 }
 
 
+bool NCTablePadBase::searchHandleInput( wint_t key )
+{
+    bool is_special = false;
+
+    if ( key > 0xFFFF )
+    {
+        is_special = true;
+        key -= 0xFFFF;
+    }
+
+    if ( ! is_special && key >= KEY_MIN ) // function keys, KEY_HOTKEY
+    {
+        _search.reset();
+        return false;
+    }
+
+    if ( _dirtyFormat || _dirtyVisibleItems )
+        UpdateFormat();
+
+    int lineNo = _search.search( key, _visibleItems, currentLineNo() );
+
+    if ( lineNo < 0 )
+        return false;
+
+    ScrlLine( lineNo );
+
+    return true;
+}
+
+
 bool NCTablePadBase::currentItemHandleInput( wint_t key )
 {
     bool handled = false;
@@ -428,10 +708,22 @@ bool NCTablePadBase::currentItemHandleInput( wint_t key )
 
     if ( currentLine )
     {
+        bool upToDate = ! _dirtyVisibleItems;
+        bool wasOpen  = currentLine->isBranchOpen();
+
         handled = currentLine->handleInput( key );
 
         if ( handled )
         {
+            // Lines added meanwhile can only be the new children of this
+            // line, so updating this branch is enough.
+
+            if ( upToDate && currentLine->isBranchOpen() != wasOpen )
+            {
+                updateVisibleBranch( currentLineNo() );
+                _dirtyVisibleItems = false;
+            }
+
             UpdateFormat();
             setpos( wpos( currentLineNo(), srect.Pos.C ) );
         }
@@ -27,8 +27,11 @@
 #define NCTablePadBase_h
 
 #include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include "NCPad.h"
 #include "NCTableItem.h"
+#include "NCTableSearch.h"
 
 class NCTableCol;
 
@@ -84,7 +87,8 @@ public:
 
     /**
      * Return the number of lines that are currently visible.
-     * This is updated in UpdateFormat().
+     * This is updated in UpdateFormat() and when a branch is opened or
+     * closed.
      **/
     unsigned visibleLines() const { return _visibleItems.size(); }
 
@@ -125,6 +129,14 @@ public:
 
     unsigned HotCol() const { return _itemStyle.HotCol(); }
 
+    /**
+     * Set the column for the type-ahead search (default: 0). A negative
+     * value disables the search.
+     **/
+    void SetSearchCol( int col ) { _search.setSearchCol( col ); }
+
+    int SearchCol() const { return _search.searchCol(); }
+
     /**
      * Expand or shrink to have exactly *count* logical lines
      **/
@@ -152,6 +164,13 @@ public:
     void Append( std::vector<NCTableCol*> & cells, int index )
         { AddLine( Lines(), new NCTableLine( cells, index ) ); }
 
+    /**
+     * Move 'line' before its sibling 'before' or, if that is 0, behind its
+     * last sibling, e.g. to keep a sorted table sorted after 'line' changed.
+     * Its child lines move with it. The cursor stays on the current line.
+     **/
+    void MoveLine( NCTableLine * line, NCTableLine * before );
+
     /**
      * Return the line at *idx* for read-only operations.
      **/
@@ -162,9 +181,20 @@ public:
      **/
     NCTableLine * ModifyLine( unsigned idx );
 
+    /**
+     * Notify the pad that the width of a cell changed without a
+     * ModifyLine() call for its line, so the column widths need to be
+     * recalculated from all lines.
+     **/
+    void CellWidthChanged() { setWidthsDirty(); }
+
     /**
      * Find the item with index 'idx' in the items and return its position.
      * Return -1 if not found.
+     *
+     * This uses a hash map from the index to the position that is rebuilt
+     * only after lines were deleted or replaced, so this is O(1) also in
+     * sorted tables.
      **/
     int findIndex( unsigned idx ) const;
 
@@ -179,8 +209,8 @@ public:
      * handled, 'false' if it should be propagated to the parent widget.
      *
      * Most of the keys are now handled in the individual items' handlers
-     * (NCTreeLine, NCTableLine). This method is mostly here as a stub for
-     * future extensions.
+     * (NCTreeLine, NCTableLine). Letters and digits that are not handled
+     * otherwise start a type-ahead search in the search column.
      *
      * Reimplemented from NCPad.
      **/
@@ -199,6 +229,17 @@ private:
      **/
     NCTableLine * getLineWithIndex( unsigned idx ) const;
 
+    /**
+     * Rebuild _linePos from _items.
+     **/
+    void updateLinePos() const;
+
+    /**
+     * Recreate the tree line graphics of 'line' and its descendants after
+     * the siblings of 'line' changed.
+     **/
+    void updatePrefixes( NCTableLine * line );
+
 
 protected:
 
@@ -210,17 +251,58 @@ protected:
      **/
     virtual bool currentItemHandleInput( wint_t key );
 
+    /**
+     * Use 'key' for the type-ahead search and move the cursor to the
+     * matching line. Return 'true' if the key was used, 'false' if it is
+     * not part of a search or no line matches.
+     **/
+    bool searchHandleInput( wint_t key );
+
     /**
      * Update the internal _visibleItems vector with the items that are
-     * currently visible: Clear the old contents of the vector, iterate over
-     * all lines and check which ones are currently visible.
+     * currently visible if lines were added, removed or changed their
+     * visibility since the last call: Clear the old contents of the vector
+     * and collect the toplevel lines and their visible descendants in tree
+     * order.
      *
      * This does NOT do a screen update of the visible items!
      **/
     void updateVisibleItems();
 
+    /**
+     * Update _visibleItems after the branch at visible line 'lineNo' was
+     * opened or closed: Replace the lines below it that belong to that branch
+     * with its currently visible descendants. This is much cheaper than
+     * rebuilding the whole vector for large tables and trees.
+     **/
+    void updateVisibleBranch( int lineNo );
+
+    /**
+     * Append the visible descendants of 'line' in tree order to 'lines'.
+     **/
+    void addVisibleChildren( const NCTableLine * line,
+                             std::vector<NCTableLine*> & lines ) const;
+
+    /**
+     * Make the next UpdateFormat() rebuild _visibleItems completely.
+     **/
+    void setVisibleItemsDirty() { _dirtyVisibleItems = true; }
+
     void setFormatDirty() { dirty = _dirtyFormat = true; }
 
+    /**
+     * Mark the format dirty and make the next UpdateFormat() recalculate the
+     * column widths from all lines, not just from the added and modified
+     * ones.
+     **/
+    void setWidthsDirty() { _dirtyWidths = true; setFormatDirty(); }
+
+    /**
+     * Take the column widths of 'line' out of the table style before it is
+     * deleted or modified.
+     **/
+    void forgetLineFormat( NCTableLine * line );
+
     virtual int dirtyPad() { return setpos( CurPos() ); }
 
     /**
@@ -238,9 +320,19 @@ protected:
 
     /**
      * Redraw the (visible) content lines one by one.
+     *
+     * When paging, this does nothing: Only the lines in the viewport are
+     * drawn on demand by directDraw().
      **/
     virtual void drawContentLines();
 
+    /**
+     * Draw the visible line 'lineNo' at 'at' in 'w'. Used when paging.
+     *
+     * Reimplemented from NCPad.
+     **/
+    virtual void directDraw( NCursesWindow & w, const wrect at, unsigned lineNo );
+
     /**
      * Redraw the table header.
      **/
@@ -291,6 +383,13 @@ protected:
     NCursesPad	              _headpad;
     bool	              _dirtyHead;
     bool	              _dirtyFormat;  ///< does table format (size) need recalculating?
+    bool	              _dirtyWidths;  ///< do column widths need recalculating from all lines?
+    bool	              _dirtyVisibleItems; ///< does _visibleItems need rebuilding?
+    std::unordered_set<NCTableLine*> _unformattedLines; ///< added or modified since UpdateFormat()
+    NCTableSearch             _search;       ///< type-ahead search in _visibleItems
+
+    mutable std::unordered_map<int, unsigned> _linePos; ///< line index -> position in _items
+    mutable bool              _dirtyLinePos; ///< does _linePos need rebuilding?
     NCTableStyle	      _itemStyle;
     wpos		      _citem;        ///< current/cursor position
 };
@@ -0,0 +1,206 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+
+/*-/
+
+   File:       NCTableSearch.cc
+
+/-*/
+
+#include <algorithm>
+#include <cwctype>
+
+#define  YUILogComponent "ncurses"
+#include <yui/YUILog.h>
+#include "NCTableSearch.h"
+#include "NCTableItem.h"
+
+// Characters typed within this many milliseconds extend the search
+#define TYPE_AHEAD_TIMEOUT 1000
+
+
+NCTableSearch::NCTableSearch( int searchCol )
+    : _searchCol( searchCol )
+    , _dirty( true )
+{
+}
+
+
+void NCTableSearch::setSearchCol( int col )
+{
+    if ( col != _searchCol )
+    {
+        _searchCol = col;
+        invalidate();
+    }
+}
+
+
+void NCTableSearch::invalidate()
+{
+    _dirty = true;
+    _modifiedLines.clear();
+}
+
+
+void NCTableSearch::lineModified( const NCTableLine * line )
+{
+    if ( ! _dirty )
+        _modifiedLines.insert( line );
+}
+
+
+int NCTableSearch::search( wchar_t ch,
+                           const std::vector<NCTableLine*> & lines,
+                           int currentLineNo )
+{
+    if ( _searchCol < 0 )
+        return -1;
+
+    Clock::time_point now = Clock::now();
+
+    if ( now - _lastKeyTime > std::chrono::milliseconds( TYPE_AHEAD_TIMEOUT ) )
+        _prefix.clear();
+
+    if ( ! iswalnum( ch ) )
+    {
+        _prefix.clear();
+        return -1;
+    }
+
+    if ( _dirty )
+        buildIndex( lines );
+    else if ( ! _modifiedLines.empty() )
+        checkModifiedLines( lines );
+
+    // Typing the first character again cycles through the lines starting
+    // with it; any other character extends the prefix.
+
+    wchar_t lower = towlower( ch );
+    bool    cycle = _prefix.size() == 1 && _prefix[0] == lower;
+
+    std::wstring prefix = cycle ? _prefix : _prefix + lower;
+    std::pair<EntryIterator, EntryIterator> range = prefixRange( prefix );
+
+    if ( range.first == range.second )
+        return -1; // no match: keep the prefix and the cursor
+
+    EntryIterator current = range.second;
+
+    if ( currentLineNo >= 0 && (unsigned) currentLineNo < _indexPos.size() )
+    {
+        EntryIterator it = _index.begin() + _indexPos[ currentLineNo ];
+
+        if ( it >= range.first && it < range.second )
+            current = it;
+    }
+
+    EntryIterator result = range.first;
+
+    if ( current != range.second )
+    {
+        // The current line matches: Stay there unless cycling
+
+        result = current;
+
+        if ( cycle && ++result == range.second )
+            result = range.first;
+    }
+
+    _prefix      = prefix;
+    _lastKeyTime = now;
+
+    return result->lineNo;
+}
+
+
+void NCTableSearch::buildIndex( const std::vector<NCTableLine*> & lines )
+{
+    _index.clear();
+    _index.reserve( lines.size() );
+
+    for ( unsigned lineNo = 0; lineNo < lines.size(); ++lineNo )
+        _index.push_back( { searchKey( lines[ lineNo ] ), lineNo } );
+
+    std::sort( _index.begin(), _index.end() );
+
+    _indexPos.resize( lines.size() );
+
+    for ( unsigned pos = 0; pos < _index.size(); ++pos )
+        _indexPos[ _index[ pos ].lineNo ] = pos;
+
+    _modifiedLines.clear();
+    _dirty = false;
+
+    yuiDebug() << "Search index for " << _index.size() << " lines" << std::endl;
+}
+
+
+void NCTableSearch::checkModifiedLines( const std::vector<NCTableLine*> & lines )
+{
+    // Most modifications (like changing a status column) don't touch the
+    // search column: Look up every modified line under its current key.
+
+    for ( const NCTableLine * line : _modifiedLines )
+    {
+        Entry entry = { searchKey( line ), 0 };
+
+        auto range = std::equal_range( _index.cbegin(), _index.cend(), entry,
+                                       []( const Entry & a, const Entry & b )
+                                       { return a.key < b.key; } );
+
+        auto it = std::find_if( range.first, range.second,
+                                [&]( const Entry & e )
+                                { return e.lineNo < lines.size() && lines[ e.lineNo ] == line; } );
+
+        if ( it == range.second )
+        {
+            buildIndex( lines );
+            return;
+        }
+    }
+
+    _modifiedLines.clear();
+}
+
+
+std::pair<NCTableSearch::EntryIterator, NCTableSearch::EntryIterator>
+NCTableSearch::prefixRange( const std::wstring & prefix ) const
+{
+    EntryIterator begin = std::lower_bound( _index.cbegin(), _index.cend(), prefix,
+                                            []( const Entry & e, const std::wstring & p )
+                                            { return e.key < p; } );
+
+    EntryIterator end = std::upper_bound( begin, _index.cend(), prefix,
+                                          []( const std::wstring & p, const Entry & e )
+                                          { return e.key.compare( 0, p.size(), p ) > 0; } );
+
+    return std::make_pair( begin, end );
+}
+
+
+std::wstring NCTableSearch::searchKey( const NCTableLine * line ) const
+{
+    const NCTableCol * col = line ? line->GetCol( _searchCol ) : 0;
+
+    if ( ! col || col->Label().getText().empty() )
+        return std::wstring();
+
+    std::wstring key = col->Label().getText().front().str();
+    std::transform( key.begin(), key.end(), key.begin(), towlower );
+
+    return key;
+}
@@ -0,0 +1,145 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+
+/*-/
+
+   File:       NCTableSearch.h
+
+/-*/
+
+#ifndef NCTableSearch_h
+#define NCTableSearch_h
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+class NCTableLine;
+
+
+/**
+ * Type-ahead search in an NCTablePadBase: Typing the first characters of
+ * the text in the search column moves the cursor to the first visible line
+ * that starts with them (case-insensitive). The typed characters are
+ * collected as long as they are typed in quick succession; typing the same
+ * character again moves to the next line starting with it.
+ *
+ * Only letters and digits start or extend a search, so keys like '+' or '-'
+ * keep their meaning in the widgets.
+ *
+ * The lookup is a binary search in a sorted index of the visible lines. The
+ * index is built on the first keystroke after the visible lines changed, so
+ * every keystroke of a search costs only O(log n).
+ **/
+class NCTableSearch
+{
+public:
+
+    NCTableSearch( int searchCol = 0 );
+
+    /**
+     * Return the column the search looks at.
+     **/
+    int searchCol() const { return _searchCol; }
+
+    /**
+     * Set the column the search looks at. A negative value disables the
+     * search.
+     **/
+    void setSearchCol( int col );
+
+    /**
+     * Handle character 'ch' typed in the table with the visible lines
+     * 'lines' and the cursor at 'currentLineNo'. Return the number of the
+     * visible line to move the cursor to or -1 if 'ch' is not part of a
+     * search or no line matches.
+     **/
+    int search( wchar_t ch,
+                const std::vector<NCTableLine*> & lines,
+                int currentLineNo );
+
+    /**
+     * Forget the characters typed so far, so the next character starts a
+     * new search.
+     **/
+    void reset() { _prefix.clear(); }
+
+    /**
+     * Notify the search that the visible lines changed, so the index needs
+     * to be rebuilt.
+     **/
+    void invalidate();
+
+    /**
+     * Notify the search that 'line' may have changed. The index is rebuilt
+     * only if the text in the search column really changed.
+     **/
+    void lineModified( const NCTableLine * line );
+
+
+private:
+
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        std::wstring key;       ///< lowercase text of the search column
+        unsigned     lineNo;
+
+        bool operator<( const Entry & other ) const
+        {
+            return key != other.key ? key < other.key : lineNo < other.lineNo;
+        }
+    };
+
+    typedef std::vector<Entry>::const_iterator EntryIterator;
+
+    /**
+     * Build the index from the visible lines.
+     **/
+    void buildIndex( const std::vector<NCTableLine*> & lines );
+
+    /**
+     * Rebuild the index if any of the modified lines changed its search key.
+     **/
+    void checkModifiedLines( const std::vector<NCTableLine*> & lines );
+
+    /**
+     * Return the index range of the entries starting with 'prefix'.
+     **/
+    std::pair<EntryIterator, EntryIterator>
+    prefixRange( const std::wstring & prefix ) const;
+
+    /**
+     * Return the lowercase text of the search column of 'line'.
+     **/
+    std::wstring searchKey( const NCTableLine * line ) const;
+
+
+    int                   _searchCol;
+    std::vector<Entry>    _index;
+    std::vector<unsigned> _indexPos;    ///< visible line no -> position in _index
+    bool                  _dirty;       ///< does _index need rebuilding?
+
+    std::unordered_set<const NCTableLine *> _modifiedLines;
+
+    std::wstring          _prefix;      ///< characters typed so far
+    Clock::time_point     _lastKeyTime;
+};
+
+
+#endif // NCTableSearch_h
@@ -14,6 +14,11 @@
 */
 
 
+#include <algorithm>
+#include <cerrno>
+#include <cwchar>
+#include <thread>
+
 #define  YUILogComponent "ncurses"
 #include <yui/YUILog.h>
 #include <yui/YTableItem.h>
@@ -21,6 +26,11 @@
 #include "NCTableSort.h"
 #include "NCTable.h"
 
+// Ranges with fewer items are sorted in the calling thread
+#define PARALLEL_SORT_MIN_ITEMS 10000
+
+#define MAX_SORT_THREADS 8
+
 
 /**
  * Support classes for sorting by column in a table for use in an NCTablePad
@@ -32,65 +42,210 @@ NCTableSortDefault::sort( YItemIterator begin, YItemIterator end )
     // yuiMilestone() << "Sorting by col #" << sortCol()
     //                << " reverse: " << std::boolalpha << reverse() << endl;
 
-    std::stable_sort( begin, end,
-                      Compare( sortCol(), reverse() ) );
+    size_t count = end - begin;
+
+    if ( count < 2 )
+        return;
+
+    std::vector<SortKey> keys( count );
+    std::vector<std::wstring> strings( count );
+    Compare compare( reverse() );
+
+    // NCstring is not thread safe, so get the strings in this thread
+
+    for ( size_t i = 0; i < count; ++i )
+        strings[ i ] = smartSortKey( begin[ i ] );
+
+    // Split the range into chunks; compute the sort keys from the strings and sort each chunk
+    // in a thread of its own, then merge the sorted chunks. Both
+    // std::stable_sort() and std::inplace_merge() are stable, so the result
+    // is the same as with a single std::stable_sort().
+
+    size_t chunks = 1;
+
+    if ( count >= PARALLEL_SORT_MIN_ITEMS )
+    {
+        chunks = std::min( (size_t) std::thread::hardware_concurrency(),
+                           (size_t) MAX_SORT_THREADS );
+        chunks = std::max( chunks, (size_t) 1 );
+    }
+
+    std::vector<size_t> bounds;
+    size_t chunkSize = ( count + chunks - 1 ) / chunks;
+
+    for ( size_t pos = 0; pos < count; pos += chunkSize )
+        bounds.push_back( pos );
+
+    bounds.push_back( count );
+    chunks = bounds.size() - 1;
+
+    auto sortChunk = [&]( size_t from, size_t to )
+    {
+        for ( size_t i = from; i < to; ++i )
+            keys[ i ] = sortKey( begin[ i ], strings[ i ] );
+
+        std::stable_sort( keys.begin() + from, keys.begin() + to, compare );
+    };
+
+    std::vector<std::thread> threads;
+
+    for ( size_t chunk = 1; chunk < chunks; ++chunk )
+    {
+        try
+        {
+            threads.emplace_back( sortChunk, bounds[ chunk ], bounds[ chunk + 1 ] );
+        }
+        catch ( const std::system_error & ex )
+        {
+            yuiWarning() << "Cannot start sort thread: " << ex.what() << std::endl;
+            sortChunk( bounds[ chunk ], bounds[ chunk + 1 ] );
+        }
+    }
+
+    sortChunk( bounds[ 0 ], bounds[ 1 ] );
+
+    for ( std::thread & thread : threads )
+        thread.join();
+
+    for ( size_t width = 1; width < chunks; width *= 2 )
+    {
+        for ( size_t chunk = 0; chunk + width < chunks; chunk += 2 * width )
+        {
+            std::inplace_merge( keys.begin() + bounds[ chunk ],
+                                keys.begin() + bounds[ chunk + width ],
+                                keys.begin() + bounds[ std::min( chunk + 2 * width, chunks ) ],
+                                compare );
+        }
+    }
+
+    for ( size_t i = 0; i < count; ++i )
+        begin[ i ] = keys[ i ].item;
 }
 
 
 bool
-NCTableSortDefault::Compare::operator() ( YItem * item1,
-					  YItem * item2 ) const
+NCTableSortDefault::resort( YItemIterator begin,
+                            YItemIterator end,
+                            YItemIterator changed )
 {
-    std::wstring w1 = smartSortKey( item1 );
-    std::wstring w2 = smartSortKey( item2 );
+    if ( changed == end )
+        return false;
+
+    Compare compare( reverse() );
+    SortKey key = sortKey( *changed );
 
-    bool ok1, ok2;
-    long long number1 = toNumber( w1, &ok1 );
-    long long number2 = toNumber( w2, &ok2 );
+    // Only the sort keys on the way to the new position are computed
 
-    if ( ok1 && ok2 )
+    auto keyLess = [&]( const SortKey & key, YItem * item )
+    {
+        return compare( key, sortKey( item ) );
+    };
+
+    if ( changed != begin && compare( key, sortKey( *( changed - 1 ) ) ) )
+    {
+        YItemIterator pos = std::upper_bound( begin, changed, key, keyLess );
+        std::rotate( pos, changed, changed + 1 );
+
+        return true;
+    }
+
+    if ( changed + 1 != end && compare( sortKey( *( changed + 1 ) ), key ) )
+    {
+        YItemIterator pos = std::upper_bound( changed + 1, end, key, keyLess );
+        std::rotate( changed, changed + 1, pos );
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool
+NCTableSortDefault::Compare::operator() ( const SortKey & key1,
+					  const SortKey & key2 ) const
+{
+    if ( key1.isNumber && key2.isNumber )
     {
 	// Both are numbers
-	return !_reverse ? number1 < number2 : number1 > number2;
+	return !_reverse ? key1.number < key2.number : key1.number > key2.number;
     }
-    else if ( ok1 && !ok2 )
+    else if ( key1.isNumber && !key2.isNumber )
     {
 	// int < string
 	return true;
     }
-    else if ( !ok1 && ok2 )
+    else if ( !key1.isNumber && key2.isNumber )
     {
 	// string > int
 	return false;
     }
     else
     {
-	// compare strings using collating information
-	int result = std::wcscoll( w1.c_str(), w2.c_str() );
+	// compare the collation keys
+	int result = key1.collationKey.compare( key2.collationKey );
 
 	return !_reverse ? result < 0 : result > 0;
     }
 }
 
 
+NCTableSortDefault::SortKey
+NCTableSortDefault::sortKey( YItem * item ) const
+{
+    return sortKey( item, smartSortKey( item ) );
+}
+
+
+NCTableSortDefault::SortKey
+NCTableSortDefault::sortKey( YItem * item, const std::wstring & str ) const
+{
+    SortKey key;
+
+    key.item   = item;
+    key.number = toNumber( str, &key.isNumber );
+
+    if ( ! key.isNumber )
+        key.collationKey = collationKey( str );
+
+    return key;
+}
+
+
 long long
-NCTableSortDefault::Compare::toNumber( const std::wstring & str, bool * ok ) const
+NCTableSortDefault::toNumber( const std::wstring & str, bool * ok ) const
 {
-    try
-    {
-	*ok = true;
-	return std::stoll( str );
-    }
-    catch (...)
-    {
-	*ok = false;
-	return 0;
-    }
+    // Same as std::stoll(), but without throwing an exception for every
+    // string that is not a number
+
+    const wchar_t * start = str.c_str();
+    wchar_t * stop = 0;
+
+    errno = 0;
+    long long number = std::wcstoll( start, &stop, 10 );
+
+    *ok = stop != start && errno != ERANGE;
+
+    return *ok ? number : 0;
 }
 
 
 std::wstring
-NCTableSortDefault::Compare::smartSortKey( YItem * item ) const
+NCTableSortDefault::collationKey( const std::wstring & str ) const
+{
+    std::wstring key;
+    size_t len = std::wcsxfrm( 0, str.c_str(), 0 );
+
+    key.resize( len + 1 );
+    std::wcsxfrm( &key[0], str.c_str(), len + 1 );
+    key.resize( len );
+
+    return key;
+}
+
+
+std::wstring
+NCTableSortDefault::smartSortKey( YItem * item ) const
 {
     std::wstring empty;
 
@@ -102,7 +257,7 @@ NCTableSortDefault::Compare::smartSortKey( YItem * item ) const
     if ( ! tableItem )
         return empty;
 
-    YTableCell * tableCell = tableItem->cell( _sortCol );
+    YTableCell * tableCell = tableItem->cell( sortCol() );
 
     if ( ! tableCell )
         return empty;
@@ -116,4 +271,3 @@ NCTableSortDefault::Compare::smartSortKey( YItem * item ) const
 
     return result.str();
 }
-
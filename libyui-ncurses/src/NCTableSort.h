@@ -51,6 +51,18 @@ public:
      **/
     virtual void sort( YItemIterator begin, YItemIterator end ) = 0;
 
+    /**
+     * Move the item at 'changed' to its sort position after its sort key
+     * changed. All other items between 'begin' and 'end' are still sorted.
+     * Return 'true' if any item was moved.
+     *
+     * This default implementation simply sorts the complete range again.
+     **/
+    virtual bool resort( YItemIterator begin,
+                         YItemIterator end,
+                         YItemIterator changed )
+        { (void) changed; sort( begin, end ); return true; }
+
 
     int  sortCol() const                { return _sortCol;    }
     void setSortCol( int col )          { _sortCol = col;     }
@@ -68,56 +80,88 @@ private:
 
 /**
  * Default sort strategy
+ *
+ * The sort key of each item is computed only once per sort: Either a number
+ * or a collation key for the current locale. Large ranges are sorted in
+ * parallel.
  **/
 class NCTableSortDefault: public NCTableSortStrategyBase
 {
 public:
     virtual void sort( YItemIterator begin, YItemIterator end ) override;
 
+    virtual bool resort( YItemIterator begin,
+                         YItemIterator end,
+                         YItemIterator changed ) override;
+
 private:
 
     /**
-     * Comparison functor.
-     *
-     * This uses the sort key of the cell if it has one, the label if not.
+     * Precomputed sort key of an item.
+     **/
+    struct SortKey
+    {
+        YItem *      item;
+        bool         isNumber;
+        long long    number;
+        std::wstring collationKey;      //< only if !isNumber
+    };
+
+    /**
+     * Comparison functor for precomputed sort keys.
      *
-     * It also tries to convert strings to numbers to do a numeric comparison
-     * if possible.
+     * Numbers are compared numerically and sorted before strings, strings
+     * are compared using the collating information of the current locale.
      **/
     class Compare
     {
     public:
-	Compare( int sortCol, bool reverse )
-	    : _sortCol( sortCol )
-            , _reverse( reverse )
+	Compare( bool reverse )
+            : _reverse( reverse )
 	    {}
 
         /**
-         * The comparison itself: Return the result of  item1 < item2
+         * The comparison itself: Return the result of  key1 < key2
          **/
-	bool operator() ( YItem * item1, YItem * item2 ) const;
+	bool operator() ( const SortKey & key1, const SortKey & key2 ) const;
 
     protected:
 
-        /**
-         * Return the sort key of column no. _sortCol for an item or, if it
-         * doesn't have one, its label in that column.
-         **/
-	std::wstring smartSortKey( YItem * item ) const;
+	const bool _reverse;
+    };
 
-        /**
-         * Try to convert a string to a number. Return the number and set the
-         * 'ok' flag to 'true' on success, to 'false' on failure.
-         **/
-	long long toNumber( const std::wstring& str, bool * ok ) const;
+    /**
+     * Compute the sort key of an item.
+     *
+     * This uses the sort key of the cell if it has one, the label if not.
+     *
+     * It also tries to convert strings to numbers to do a numeric comparison
+     * if possible.
+     **/
+    SortKey sortKey( YItem * item ) const;
 
+    /**
+     * Compute the sort key of an item from its smartSortKey() string.
+     **/
+    SortKey sortKey( YItem * item, const std::wstring & str ) const;
 
-        // Data members
+    /**
+     * Return the sort key of column no. sortCol() for an item or, if it
+     * doesn't have one, its label in that column.
+     **/
+    std::wstring smartSortKey( YItem * item ) const;
 
-	const int  _sortCol;
-	const bool _reverse;
-    };
+    /**
+     * Try to convert a string to a number. Return the number and set the
+     * 'ok' flag to 'true' on success, to 'false' on failure.
+     **/
+    long long toNumber( const std::wstring & str, bool * ok ) const;
 
+    /**
+     * Return the collation key of a string: Comparing two collation keys
+     * gives the same result as comparing the strings with wcscoll().
+     **/
+    std::wstring collationKey( const std::wstring & str ) const;
 };
 
 
@@ -0,0 +1,128 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+
+/*-/
+
+   File:       NCTimer.cc
+
+/-*/
+
+#include <algorithm>
+#include <vector>
+
+#define  YUILogComponent "ncurses"
+#include <yui/YUILog.h>
+#include "NCTimer.h"
+
+
+std::set<NCTimer *> NCTimer::_activeTimers;
+
+
+NCTimer::NCTimer( int intervalMillisec, Callback callback )
+    : _interval( std::max( intervalMillisec, 1 ) )
+    , _callback( callback )
+{
+}
+
+
+NCTimer::~NCTimer()
+{
+    stop();
+}
+
+
+void NCTimer::start()
+{
+    _due = nextDue( Clock::now() );
+    _activeTimers.insert( this );
+}
+
+
+void NCTimer::stop()
+{
+    _activeTimers.erase( this );
+}
+
+
+bool NCTimer::active() const
+{
+    return _activeTimers.find( const_cast<NCTimer *>( this ) ) != _activeTimers.end();
+}
+
+
+void NCTimer::setInterval( int intervalMillisec )
+{
+    _interval = std::max( intervalMillisec, 1 );
+}
+
+
+NCTimer::Clock::time_point NCTimer::nextDue( Clock::time_point now ) const
+{
+    Clock::duration interval = std::chrono::milliseconds( _interval );
+
+    return now - now.time_since_epoch() % interval + interval;
+}
+
+
+int NCTimer::waitTime( int timeoutMillisec )
+{
+    int wait = timeoutMillisec;
+
+    if ( _activeTimers.empty() )
+        return wait < 0 ? -1 : wait;
+
+    Clock::time_point now = Clock::now();
+
+    for ( NCTimer * timer : _activeTimers )
+    {
+        // round up: waking up too early would just mean waiting again
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>( timer->_due - now ).count();
+        int millisec = left > 0 ? (int) ( ( left + 999 ) / 1000 ) : 0;
+
+        if ( wait < 0 || millisec < wait )
+            wait = millisec;
+    }
+
+    return wait;
+}
+
+
+bool NCTimer::runDueTimers()
+{
+    Clock::time_point now = Clock::now();
+    std::vector<NCTimer *> due;
+
+    for ( NCTimer * timer : _activeTimers )
+    {
+        if ( timer->_due <= now )
+            due.push_back( timer );
+    }
+
+    for ( NCTimer * timer : due )
+    {
+        // A callback might have stopped or deleted any of the other timers
+        if ( _activeTimers.find( timer ) == _activeTimers.end() )
+            continue;
+
+        // Stay on the interval grid to avoid drifting, but don't try to
+        // catch up with missed calls
+        timer->_due = timer->nextDue( now );
+
+        timer->_callback();
+    }
+
+    return ! due.empty();
+}
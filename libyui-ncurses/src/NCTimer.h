@@ -0,0 +1,117 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+
+/*-/
+
+   File:       NCTimer.h
+
+/-*/
+
+#ifndef NCTimer_h
+#define NCTimer_h
+
+#include <chrono>
+#include <functional>
+#include <set>
+
+
+/**
+ * A periodic timer for widgets that need to do something while the dialog
+ * waits for user input, e.g. animations or polling.
+ *
+ * There are no signals and no threads involved: The callbacks are called
+ * from NCDialog::getch() which waits for input only until the next timer is
+ * due. Any number of timers can be active at the same time.
+ *
+ * Timers with the same interval are due at the same time, no matter when
+ * they were started, so e.g. several animations are drawn in one screen
+ * update.
+ **/
+class NCTimer
+{
+public:
+
+    typedef std::function<void()> Callback;
+
+    /**
+     * Constructor. The timer is not started yet.
+     **/
+    NCTimer( int intervalMillisec, Callback callback );
+
+    /**
+     * Destructor. This stops the timer.
+     **/
+    ~NCTimer();
+
+    /**
+     * Start the timer: The callback is called every 'interval()'
+     * milliseconds from now on, the first time after at most 'interval()'
+     * milliseconds. Restart it if it is already active.
+     **/
+    void start();
+
+    /**
+     * Stop the timer.
+     **/
+    void stop();
+
+    /**
+     * Return 'true' if the timer is started.
+     **/
+    bool active() const;
+
+    int interval() const { return _interval; }
+
+    /**
+     * Set the interval. This takes effect the next time the timer is due or
+     * started.
+     **/
+    void setInterval( int intervalMillisec );
+
+    /**
+     * Return the number of milliseconds until the next active timer is due,
+     * but at most 'timeoutMillisec'. A negative timeout means no limit; -1
+     * is returned if there is neither a timeout nor an active timer.
+     **/
+    static int waitTime( int timeoutMillisec = -1 );
+
+    /**
+     * Call the callbacks of all timers that are due and schedule them
+     * again. Return 'true' if any callback was called.
+     **/
+    static bool runDueTimers();
+
+private:
+
+    NCTimer( const NCTimer & );
+    NCTimer & operator=( const NCTimer & );
+
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Return the next multiple of the interval on the clock after 'now'.
+     **/
+    Clock::time_point nextDue( Clock::time_point now ) const;
+
+    int               _interval;
+    Callback          _callback;
+    Clock::time_point _due;
+
+    static std::set<NCTimer *> _activeTimers;
+};
+
+
+#endif // NCTimer_h
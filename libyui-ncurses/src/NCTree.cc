@@ -159,7 +159,9 @@ void NCTree::selectItem( YItem * item, bool selected )
     NCTreeLine * currentLine = 0;
     NCTableCol * currentCol  = 0;
 
-    if ( _multiSelect )
+    // Lines that are not created yet take the selection state from the item
+
+    if ( _multiSelect && findTreeLine( treeItem ) )
     {
 	currentLine = modifyTreeLine( at );
 
@@ -197,7 +199,7 @@ void NCTree::selectItem( YItem * item, bool selected )
 	// Highlight the selected item and possibly expand the tree if it is in
 	// a currently hidden branch
 
-	myPad()->ShowItem( getTreeLine( at ) );
+	myPad()->ShowItem( createTreeLine( treeItem ) );
     }
 }
 
@@ -241,49 +243,82 @@ void NCTree::CreateTreeLines( NCTreeLine * parentLine,
                               NCTreePad  * pad,
                               YItem      * item )
 {
-    // Set the item index explicitely: It is set to -1 by default which makes
-    // selecting items painful.
-
-    item->setIndex( _nextItemIndex++ );
-
     YTreeItem * treeItem = dynamic_cast<YTreeItem *>( item );
     YUI_CHECK_PTR( treeItem );
 
-    NCTreeLine * line = new NCTreeLine( parentLine, treeItem, _multiSelect );
+    NCTreeLine * line = new NCTreeLine( parentLine, treeItem, _multiSelect, this );
     pad->Append( line );
 
-    if ( item->selected() )
+    // Recursively create TreeLines for the children of this item.
+    // The children of a closed item are created when it is opened.
+
+    if ( treeItem->isOpen() )
     {
-        // Retrieve the position of the item
-        int at = treeItem->index();
+	for ( YItemIterator it = item->childrenBegin();  it < item->childrenEnd(); ++it )
+	{
+	    CreateTreeLines( line, pad, *it );
+	}
+    }
+}
 
-        NCTreeLine * currentLine = 0;
-        NCTableCol * currentCol = 0;
 
-        if ( _multiSelect )
-        {
-            currentLine = modifyTreeLine( at );
+void NCTree::CreateChildLines( NCTreeLine * parentLine )
+{
+    if ( !myPad() || parentLine->firstChild() )
+	return;
 
-            if ( currentLine )
-                currentCol = currentLine->GetCol(0);
+    YItem * item = parentLine->YItem();
 
-            if ( currentCol )
-            {
-                currentCol->setPrefix( currentLine->indentationStr() + "[x] " );
-            }
-        }
+    for ( YItemIterator it = item->childrenBegin();  it < item->childrenEnd(); ++it )
+    {
+	CreateTreeLines( parentLine, myPad(), *it );
+    }
+}
 
-        // Highlight the selected item and expand the tree if it is in a
-        // currently hidden branch
 
-        pad->ShowItem( getTreeLine( at ) );
+NCTreeLine * NCTree::findTreeLine( YTreeItem * item ) const
+{
+    // Check first: getTreeLine() complains about missing lines
+
+    if ( !myPad() || myPad()->findIndex( item->index() ) < 0 )
+	return 0;
+
+    return const_cast<NCTreeLine *>( getTreeLine( item->index() ) );
+}
+
+
+NCTreeLine * NCTree::createTreeLine( YTreeItem * item )
+{
+    NCTreeLine * line = findTreeLine( item );
+
+    if ( !line && item->parent() )
+    {
+	NCTreeLine * parentLine = createTreeLine( item->parent() );
+
+	if ( parentLine )
+	{
+	    CreateChildLines( parentLine );
+	    line = findTreeLine( item );
+	}
     }
 
-    // Recursively create TreeLines for the children of this item
+    return line;
+}
+
+
+void NCTree::setItemIndexes( YItem * item, YItemCollection & selectedItems )
+{
+    // Set the item index explicitely: It is set to -1 by default which makes
+    // selecting items painful.
+
+    item->setIndex( _nextItemIndex++ );
+
+    if ( item->selected() )
+	selectedItems.push_back( item );
 
     for ( YItemIterator it = item->childrenBegin();  it < item->childrenEnd(); ++it )
     {
-	CreateTreeLines( line, pad, *it );
+	setItemIndexes( *it, selectedItems );
     }
 }
 
@@ -302,18 +337,30 @@ void NCTree::DrawPad()
 	return;
     }
 
+    // Number all items, not only the ones that get a line now
+
+    YItemCollection selectedItems;
     _nextItemIndex = 0;
 
+    for ( YItemIterator it = itemsBegin(); it < itemsEnd(); ++it )
+	setItemIndexes( *it, selectedItems );
+
     // Iterate over the toplevel items
 
     for ( YItemIterator it = itemsBegin(); it < itemsEnd(); ++it )
     {
         // Create a TreeLine for this item.
-        // This will recurse into children if there are any.
+        // This will recurse into the children of open items.
 
 	CreateTreeLines( 0, myPad(), *it );
     }
 
+    // Highlight the selected items and expand the tree if they are in a
+    // currently hidden branch
+
+    for ( YItem * item : selectedItems )
+	myPad()->ShowItem( createTreeLine( dynamic_cast<YTreeItem *>( item ) ) );
+
     NCPadWidget::DrawPad();
 }
 
@@ -416,7 +463,8 @@ void NCTree::deleteAllItems()
 
 NCTreeLine::NCTreeLine( NCTreeLine * parentLine,
                         YTreeItem  * item,
-                        bool         multiSelection )
+                        bool         multiSelection,
+                        NCTree     * tree )
     : NCTableLine( parentLine,
                    item,
                    0,                         // cols
@@ -424,6 +472,7 @@ NCTreeLine::NCTreeLine( NCTreeLine * parentLine,
                    true,                      // nested
                    S_NORMAL )                 // lineState
     , _multiSelect( multiSelection )
+    , _tree( tree )
 {
     if ( _multiSelect )
         _prefixPlaceholder += item->selected() ? "[x] " : "[ ] ";
@@ -475,6 +524,13 @@ bool NCTreeLine::ChangeToVisible()
 }
 
 
+void NCTreeLine::createChildLines()
+{
+    if ( _tree )
+        _tree->CreateChildLines( this );
+}
+
+
 unsigned NCTreeLine::Hotspot( unsigned & at ) const
 {
     return 6;
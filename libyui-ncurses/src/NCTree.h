@@ -46,6 +46,7 @@ class NCTreeLine;
 class NCTree : public YTree, public NCPadWidget
 {
     friend std::ostream & operator<<( std::ostream & str, const NCTree & obj );
+    friend class NCTreeLine;
 
 public:
 
@@ -187,7 +188,11 @@ protected:
         { return dynamic_cast<NCTreePad*>( NCPadWidget::myPad() ); }
 
     /**
-     * Fill the TreePad with lines (using CreateTreeLines to create them)
+     * Fill the TreePad with lines (using CreateTreeLines to create them).
+     *
+     * Lines are only created for the toplevel items and the children of open
+     * items. The lines for the children of a closed item are created when it
+     * is opened, so even huge trees are displayed quickly.
      **/
     virtual void DrawPad();
 
@@ -223,12 +228,29 @@ protected:
 
     /**
      * Create TreeLines and append them to the TreePad.
-     * If 'item' has any children, this is called recursively for them.
+     * If 'item' is open, this is called recursively for its children.
      **/
     void CreateTreeLines( NCTreeLine * parentLine,
                           NCTreePad  * pad,
                           YItem      * item );
 
+    /**
+     * Create the TreeLines for the children of 'parentLine' if they do not
+     * exist yet. This is called when that branch is opened.
+     **/
+    void CreateChildLines( NCTreeLine * parentLine );
+
+    /**
+     * Return the tree line for 'item' or 0 if it was not created yet.
+     **/
+    NCTreeLine * findTreeLine( YTreeItem * item ) const;
+
+    /**
+     * Return the tree line for 'item'. Create it and the lines of its
+     * siblings and ancestors if needed.
+     **/
+    NCTreeLine * createTreeLine( YTreeItem * item );
+
 private:
 
     // Disable unwanted assignment operator and copy constructor
@@ -236,13 +258,19 @@ private:
     NCTree & operator=( const NCTree & );
     NCTree( const NCTree & );
 
+    /**
+     * Set the index of 'item' and its descendants to their position in the
+     * whole tree and collect the selected items in 'selectedItems'.
+     **/
+    void setItemIndexes( YItem * item, YItemCollection & selectedItems );
+
 
     //
     // Data members
     //
 
     bool _multiSelect;
-    int  _nextItemIndex; // Only used in CreateTreeLines()
+    int  _nextItemIndex; // Only used in setItemIndexes()
 };
 
 
@@ -264,7 +292,8 @@ public:
 
     NCTreeLine( NCTreeLine * parentLine,
                 YTreeItem  * origItem,
-                bool         multiSelection );
+                bool         multiSelection,
+                NCTree     * tree = 0 );
 
     virtual ~NCTreeLine();
 
@@ -288,6 +317,15 @@ public:
      **/
     virtual bool ChangeToVisible();
 
+    /**
+     * Return 'true' if the item has children, even if their lines were not
+     * created yet.
+     *
+     * Reimplemented from NCTableLine.
+     **/
+    virtual bool hasChildren() const
+        { return _firstChild || ( _yitem && _yitem->hasChildren() ); }
+
     virtual unsigned Hotspot( unsigned & at ) const;
 
     /**
@@ -306,13 +344,24 @@ public:
     virtual NCTreeLine * nextSibling() const { return dynamic_cast<NCTreeLine *>( _nextSibling ); }
 
 
+protected:
+
+    /**
+     * Let the tree create the lines for the children of this line.
+     *
+     * Reimplemented from NCTableLine.
+     **/
+    virtual void createChildLines();
+
+
 private:
 
     //
     // Data members
     //
 
-    bool _multiSelect;
+    bool     _multiSelect;
+    NCTree * _tree;
 };
 
 
@@ -57,7 +57,10 @@ void NCTreePad::ShowItem( const NCTableLine * item )
     if ( !item )
 	return;
 
-    if ( const_cast<NCTableLine *>( item )->ChangeToVisible() || _dirtyFormat )
+    if ( const_cast<NCTableLine *>( item )->ChangeToVisible() )
+	setVisibleItemsDirty();
+
+    if ( _dirtyVisibleItems || _dirtyFormat )
 	UpdateFormat();
 
     for ( unsigned i = 0; i < visibleLines(); ++i )
@@ -0,0 +1,41 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+
+/*-/
+
+   File:       NCVirtualPad.cc
+
+/-*/
+
+#define  YUILogComponent "ncurses"
+#include <yui/YUILog.h>
+#include "NCVirtualPad.h"
+
+
+NCVirtualPad::NCVirtualPad( int lines, int cols, const NCWidget & p, LineDrawer drawLine )
+    : NCPad( lines, cols, p )
+    , _drawLine( drawLine )
+{
+    // page with any number of lines; the first resize truncates the pad
+    setMaxPadHeight( 0 );
+}
+
+
+void NCVirtualPad::directDraw( NCursesWindow & w, const wrect at, unsigned lineNo )
+{
+    if ( _drawLine )
+	_drawLine( w, at.Pos.L, lineNo );
+}
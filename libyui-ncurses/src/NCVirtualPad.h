@@ -0,0 +1,77 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+
+/*-/
+
+   File:       NCVirtualPad.h
+
+/-*/
+
+#ifndef NCVirtualPad_h
+#define NCVirtualPad_h
+
+#include <functional>
+
+#include "NCPad.h"
+
+
+/**
+ * An NCPad for long read-only texts (NCRichText, NCLogView) that does not
+ * hold the text itself.
+ *
+ * This pad is always paging (see NCPad::paging()): It only has the size of
+ * the viewport, and each time it is updated the visible lines are drawn
+ * into it by a callback of the widget. So scrolling and the memory needed
+ * do not depend on the length of the text.
+ **/
+class NCVirtualPad : public NCPad
+{
+public:
+
+    /**
+     * Draw text line 'lineNo' into row 'row' of 'w'. The callback has to
+     * clear the row first; 'lineNo' may be beyond the end of the text if
+     * the text is shorter than the viewport.
+     **/
+    typedef std::function<void( NCursesWindow & w, int row, unsigned lineNo )> LineDrawer;
+
+    /**
+     * Constructor. 'lines' and 'cols' are the initial size, use resize()
+     * to set the size of the text.
+     **/
+    NCVirtualPad( int lines, int cols, const NCWidget & p, LineDrawer drawLine );
+
+    virtual ~NCVirtualPad() {}
+
+    /**
+     * The number of (virtual) lines.
+     **/
+    int Lines() const { return vheight(); }
+
+protected:
+
+    /**
+     * Reimplemented from NCPad: Call the LineDrawer.
+     **/
+    virtual void directDraw( NCursesWindow & w, const wrect at, unsigned lineNo );
+
+private:
+
+    LineDrawer _drawLine;
+};
+
+
+#endif // NCVirtualPad_h
@@ -24,9 +24,12 @@
 /-*/
 
 
+#include <algorithm>
+#include <cwchar>
 #include <cwctype>
 #include <iostream>
 #include "NCWordWrapper.h"
+#include "NCstring.h"
 
 
 #define DEFAULT_LINE_WIDTH      78
@@ -38,8 +41,7 @@ using std::wcout;
 
 NCWordWrapper::NCWordWrapper():
     _lineWidth( DEFAULT_LINE_WIDTH ),
-    _lines( 0 ),
-    _dirty( false )
+    _dirtyFrom( wstring::npos )
 {
 
 }
@@ -47,11 +49,55 @@ NCWordWrapper::NCWordWrapper():
 
 void NCWordWrapper::setText( const wstring & origText )
 {
-    if ( origText != _origText )
+    size_t common = std::mismatch( _origText.begin(), _origText.end(),
+                                   origText.begin(), origText.end() ).first - _origText.begin();
+
+    if ( common == _origText.size() && common == origText.size() )
+        return;
+
+    // Everything up to the first difference can stay normalized and wrapped
+    // as it is. Start at a non-whitespace character to get the blanks right.
+
+    while ( common > 0 && isWhitespace( _origText[ common - 1 ] ) )
+        --common;
+
+    size_t normalizedCommon = 0;
+    bool   skippingWhitespace = false;
+
+    for ( size_t i = 0; i < common; i++ )
     {
-        _origText = origText;
-        _dirty = true;
+        if ( isWhitespace( _origText[i] ) )
+        {
+            skippingWhitespace = normalizedCommon > 0;
+        }
+        else
+        {
+            normalizedCommon += skippingWhitespace ? 2 : 1;
+            skippingWhitespace = false;
+        }
     }
+
+    _origText = origText;
+    _normalizedText.resize( normalizedCommon );
+    appendNormalized( _normalizedText, _origText, common, false );
+    _dirtyFrom = std::min( _dirtyFrom, normalizedCommon );
+}
+
+
+void NCWordWrapper::appendText( const wstring & text )
+{
+    if ( text.empty() )
+        return;
+
+    size_t oldSize         = _origText.size();
+    size_t oldNormalized   = _normalizedText.size();
+    bool   trailingBlank   = oldSize > 0 && isWhitespace( _origText.back() );
+
+    _origText += text;
+    appendNormalized( _normalizedText, _origText, oldSize, trailingBlank && oldNormalized > 0 );
+
+    if ( _normalizedText.size() > oldNormalized )
+        _dirtyFrom = std::min( _dirtyFrom, oldNormalized );
 }
 
 
@@ -60,7 +106,7 @@ void NCWordWrapper::setLineWidth( int width )
     if ( width != _lineWidth )
     {
         _lineWidth = width;
-        _dirty = true;
+        _dirtyFrom = 0;
     }
 }
 
@@ -68,10 +114,11 @@ void NCWordWrapper::setLineWidth( int width )
 void NCWordWrapper::clear()
 {
     _origText.clear();
+    _normalizedText.clear();
     _wrappedText.clear();
+    _lines.clear();
     _lineWidth = DEFAULT_LINE_WIDTH;
-    _lines = 0;
-    _dirty = false;
+    _dirtyFrom = wstring::npos;
 }
 
 
@@ -79,7 +126,7 @@ int NCWordWrapper::lines()
 {
     ensureWrapped();
 
-    return _lines;
+    return _lines.size();
 }
 
 
@@ -91,12 +138,52 @@ const wstring & NCWordWrapper::wrappedText()
 }
 
 
+const std::vector<NCWordWrapper::Line> & NCWordWrapper::wrappedLines()
+{
+    ensureWrapped();
+
+    return _lines;
+}
+
+
 void NCWordWrapper::ensureWrapped()
 {
-    if ( _dirty )
-        wrap();
+    if ( _dirtyFrom != wstring::npos )
+        rewrapFrom( _dirtyFrom );
+
+    _dirtyFrom = wstring::npos;
+}
 
-    _dirty = false;
+
+bool NCWordWrapper::isWhitespace( wchar_t c )
+{
+    switch ( c )
+    {
+        case L' ':
+        case L'\t':
+        case L'\n':
+        case L'\v':
+        case L'\r':
+        case L'\f':
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+int NCWordWrapper::charWidth( wchar_t c )
+{
+#ifdef WORD_WRAPPER_TESTER
+    // The standalone tester is built without NCstring.cc
+    int width = wcwidth( c );
+#else
+    int width = NCstring::charWidth( c );
+#endif
+
+    // Non-printable: Better too wide than too narrow
+    return width < 0 ? 1 : width;
 }
 
 
@@ -104,138 +191,197 @@ wstring NCWordWrapper::normalizeWhitespace( const wstring & orig )
 {
     wstring normalized;
     normalized.reserve( orig.size() );
-    bool skippingWhitespace = false;
+    appendNormalized( normalized, orig, 0, false );
+
+    return normalized;
+}
+
 
-    for ( wchar_t c: orig )
+void NCWordWrapper::appendNormalized( wstring &       normalized,
+                                      const wstring & orig,
+                                      size_t          from,
+                                      bool            skippingWhitespace )
+{
+    for ( size_t i = from; i < orig.size(); i++ )
     {
-        switch ( c )
+        wchar_t c = orig[i];
+
+        if ( isWhitespace( c ) )
         {
-	    case L' ':  // Whitespace
-	    case L'\t':
-	    case L'\n':
-	    case L'\v':
-	    case L'\r':
-            case L'\f':
-                // Don't add any whitespace right now: Wait until there is real content.
-
-                if ( ! normalized.empty() ) // Ignore any leading whitspace
-                    skippingWhitespace = true;
-                break;
-
-            default:    // Non-whitespace
-
-                // Add one blank for any skipped whitespace.
-                //
-                // This will not add trailing whitespace which is exactly the
-                // desired behaviour.
-
-                if ( skippingWhitespace )
-                    normalized += ' ';
-
-                normalized += c;
-                skippingWhitespace = false;
-                break;
+            // Don't add any whitespace right now: Wait until there is real content.
+
+            if ( ! normalized.empty() ) // Ignore any leading whitspace
+                skippingWhitespace = true;
         }
-    }
+        else
+        {
+            // Add one blank for any skipped whitespace.
+            //
+            // This will not add trailing whitespace which is exactly the
+            // desired behaviour.
 
-    return normalized;
+            if ( skippingWhitespace )
+                normalized += ' ';
+
+            normalized += c;
+            skippingWhitespace = false;
+        }
+    }
 }
 
 
 void NCWordWrapper::wrap()
 {
-    wstring unwrapped = normalizeWhitespace( _origText );
-    _wrappedText.clear();
-    _wrappedText.reserve( unwrapped.size() );
-    _lines = 0;
+    rewrapFrom( 0 );
+    _dirtyFrom = wstring::npos;
+}
+
+
+void NCWordWrapper::rewrapFrom( size_t offset )
+{
+    // Drop the lines that might wrap differently now. The scanEnd of the
+    // lines is ascending, so the lines to keep are at the front.
+
+    while ( ! _lines.empty() && _lines.back().scanEnd > offset )
+        _lines.pop_back();
+
+    size_t start = 0;
+
+    if ( _lines.empty() )
+    {
+        _wrappedText.clear();
+        _wrappedText.reserve( _normalizedText.size() );
+    }
+    else
+    {
+        const Line & last = _lines.back();
+        start = last.start + last.length;
+
+        // Skip the blank the last line was wrapped at
+        if ( start < _normalizedText.size() && _normalizedText[ start ] == L' ' )
+            ++start;
+
+        _wrappedText.resize( last.wrappedStart + last.length );
+    }
 
-    while ( ! unwrapped.empty() )
+    while ( start < _normalizedText.size() )
     {
-        wstring line = nextLine( unwrapped );
+        Line line = nextLine( start );
 
 #ifdef WORD_WRAPPER_TESTER
-        wcout << "Line: \"" << line << "\"  length: " << line.size() << endl;
-        wcout << "Rest: \"" << unwrapped << "\"\n" << endl;
+        wcout << "Line: \"" << _normalizedText.substr( line.start, line.length )
+              << "\"  width: " << line.width << endl;
 #endif
 
-        if ( ! _wrappedText.empty() )
+        if ( ! _lines.empty() )
             _wrappedText += L'\n';
 
-        _wrappedText += line;
-        _lines++;
-    }
+        line.wrappedStart = _wrappedText.size();
+        _wrappedText.append( _normalizedText, line.start, line.length );
+        _lines.push_back( line );
+
+        start = line.start + line.length;
 
-    _dirty = false;
+        if ( start < _normalizedText.size() && _normalizedText[ start ] == L' ' )
+            ++start;
+    }
 }
 
 
-wstring NCWordWrapper::nextLine( wstring & unwrapped )
+NCWordWrapper::Line NCWordWrapper::nextLine( size_t start ) const
 {
-    wstring line;
+    const wstring & text = _normalizedText;
+    Line line = { start, 0, 0, 0, 0 };
 
-#ifdef WORD_WRAPPER_TESTER
-    wcout << "nextLine( \"" << unwrapped << "\" )" << endl;
-#endif
+    // Find out how many characters fit into the line width
+
+    size_t fitEnd = start;
+    int    width  = 0;
 
-    if ( (int) unwrapped.size() <= _lineWidth )
+    while ( fitEnd < text.size() )
     {
-        // The remaining unwrapped text fits into one line
+        int charCols = charWidth( text[ fitEnd ] );
 
-        line = unwrapped;
-        unwrapped.clear();
+        if ( width + charCols > _lineWidth )
+            break;
 
-        return line;
+        width += charCols;
+        ++fitEnd;
     }
 
+    if ( fitEnd == text.size() )
+    {
+        // The remaining unwrapped text fits into one line. Anything appended
+        // to the text might change that.
 
-    // Try to wrap at the rightmost possible whitespace
+        line.length  = fitEnd - start;
+        line.width   = width;
+        line.scanEnd = text.size() + 1;
 
-    int pos = _lineWidth; // The whitespace will be removed here
+        return line;
+    }
 
-    while ( pos > 0 && unwrapped[ pos ] != L' ' )
-        --pos;
+    // Everything below looks at most at the first character that does not fit
+    line.scanEnd = fitEnd + 1;
 
-    if ( unwrapped[ pos ] == L' ' )
+    if ( fitEnd == start )
     {
-        line = unwrapped.substr( 0, pos );
-        unwrapped.erase( 0, pos + 1 );
+        // Not even one character fits (a double-width character in a
+        // one-column line): Use it anyway to make progress.
+
+        line.length = 1;
+        line.width  = charWidth( text[ start ] );
 
         return line;
     }
 
 
-    // Try to wrap at the rightmost possible non-alphanum character
+    // Try to wrap at the rightmost possible whitespace
 
-    pos = _lineWidth - 1; // We'll need to keep the separator character
+    size_t pos = fitEnd; // The whitespace will be removed here
 
-    while ( pos > 0 && iswalnum( unwrapped[ pos ] ) )
+    while ( pos > start && text[ pos ] != L' ' )
         --pos;
 
-    if ( ! iswalnum( unwrapped[ pos ] ) )
+    if ( text[ pos ] == L' ' )
     {
-#ifdef WORD_WRAPPER_TESTER
-        wcout << "iswalnum wrap" << endl;
-#endif
-
-        line = unwrapped.substr( 0, pos + 1 );
-        unwrapped.erase( 0, pos + 1 );
-
-        return line;
+        line.length = pos - start;
     }
+    else
+    {
+        // Try to wrap at the rightmost possible non-alphanum character
 
+        pos = fitEnd - 1; // We'll need to keep the separator character
 
-    // Still no chance to break the line? So we'll have to break in mid-word.
-    // This is crude and brutal, but in some locales (Chinese, Japanese,
-    // Korean) there is very little whitespace, so sometimes we have no other
-    // choice.
+        while ( pos > start && iswalnum( text[ pos ] ) )
+            --pos;
 
+        if ( ! iswalnum( text[ pos ] ) )
+        {
 #ifdef WORD_WRAPPER_TESTER
-    wcout << "desperation wrap" << endl;
+            wcout << "iswalnum wrap" << endl;
 #endif
+            line.length = pos + 1 - start;
+        }
+        else
+        {
+            // Still no chance to break the line? So we'll have to break in
+            // mid-word. This is crude and brutal, but in some locales
+            // (Chinese, Japanese, Korean) there is very little whitespace, so
+            // sometimes we have no other choice.
+
+#ifdef WORD_WRAPPER_TESTER
+            wcout << "desperation wrap" << endl;
+#endif
+            line.length = fitEnd - start;
+        }
+    }
+
+    // Subtract the columns of the characters that went to the next line
+    for ( size_t i = start + line.length; i < fitEnd; i++ )
+        width -= charWidth( text[ i ] );
 
-    pos = _lineWidth - 1;
-    line = unwrapped.substr( 0, pos + 1 );
-    unwrapped.erase( 0, pos + 1 );
+    line.width = width;
 
     return line;
 }
@@ -28,17 +28,37 @@
 #define NCWordWrapper_h
 
 #include <string>
+#include <vector>
 
 /**
  * Helper class to word-wrap text into a specified maximum line width.
  * Whitespace is normalized in the process, i.e. any sequence of whitespace
  * (blanks, newlines, tabs, ...) is replaced by a single blank. All lines end
  * with a single newline character except the last one which has no newline.
+ *
+ * The line width is measured in screen columns, not in characters, so
+ * double-width (CJK) characters count twice.
+ *
+ * The wrapped lines are kept as spans (start and length) into the normalized
+ * text, so wrapping does not copy the text around. When the text changes,
+ * only the lines from the first change on are wrapped again.
  **/
 class NCWordWrapper
 {
 public:
 
+    /**
+     * One wrapped line: A part of the normalized text.
+     **/
+    struct Line
+    {
+        size_t start;           ///< offset in normalizedText()
+        size_t length;          ///< number of characters
+        int    width;           ///< screen columns
+        size_t wrappedStart;    ///< offset in wrappedText()
+        size_t scanEnd;         ///< the wrapping depended on the text up to here
+    };
+
     /**
      * Constructor.
      **/
@@ -46,11 +66,20 @@ public:
 
     /**
      * Set the original text to wrap.
+     *
+     * If the new text starts like the old one, only the lines after that
+     * common part are wrapped again.
      **/
     void setText( const std::wstring & origText );
 
     /**
-     * Set the maximum line width to wrap into.
+     * Append text to the original text. This is cheaper than setText() with
+     * the complete text since the old text is not compared.
+     **/
+    void appendText( const std::wstring & text );
+
+    /**
+     * Set the maximum line width (in screen columns) to wrap into.
      **/
     void setLineWidth( int width );
 
@@ -64,6 +93,17 @@ public:
      **/
     const std::wstring & wrappedText();
 
+    /**
+     * Wrap the original text and return the wrapped lines as spans into
+     * normalizedText().
+     **/
+    const std::vector<Line> & wrappedLines();
+
+    /**
+     * Return the original text with normalized whitespace.
+     **/
+    const std::wstring & normalizedText() const { return _normalizedText; }
+
     /**
      * Return the original unwrapped text.
      **/
@@ -80,6 +120,11 @@ public:
      **/
     static std::wstring normalizeWhitespace( const std::wstring & orig );
 
+    /**
+     * Return the number of screen columns of character 'c'.
+     **/
+    static int charWidth( wchar_t c );
+
     /**
      * Do the wrapping.
      *
@@ -105,20 +150,42 @@ protected:
     void ensureWrapped();
 
     /**
-     * Return the next line that fits into the line width and removed it from
-     * 'unwrapped'.
+     * Rewrap starting with the first line that depends on the normalized
+     * text from 'offset' on.
+     **/
+    void rewrapFrom( size_t offset );
+
+    /**
+     * Return the next line starting at offset 'start' of the normalized text
+     * that fits into the line width.
+     **/
+    Line nextLine( size_t start ) const;
+
+    /**
+     * Append the normalized whitespace of 'orig' from 'from' on to
+     * 'normalized'. 'skippingWhitespace' tells if whitespace was skipped
+     * right before 'from'.
+     **/
+    static void appendNormalized( std::wstring &       normalized,
+                                  const std::wstring & orig,
+                                  size_t               from,
+                                  bool                 skippingWhitespace );
+
+    /**
+     * Return 'true' if 'c' is whitespace to be normalized.
      **/
-    std::wstring nextLine( std::wstring & unwrapped );
+    static bool isWhitespace( wchar_t c );
 
     //
     // Data members
     //
 
-    std::wstring _origText;
-    std::wstring _wrappedText;
-    int          _lineWidth;
-    int          _lines;
-    bool         _dirty;
+    std::wstring      _origText;
+    std::wstring      _normalizedText;
+    std::wstring      _wrappedText;
+    std::vector<Line> _lines;
+    int               _lineWidth;
+    size_t            _dirtyFrom;  ///< offset in _normalizedText; npos: nothing to do
 };
 
 #endif  // NCWordWrapper_h
@@ -24,11 +24,26 @@
 
 #include <errno.h>
 #include <iconv.h>
-#include <malloc.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <wchar.h>
+
+#include <algorithm>
+#include <vector>
 
 #define  YUILogComponent "ncurses"
 #include <yui/YUILog.h>
 #include "NCstring.h"
+#include "NCurses.h"
+
+
+// wcwidth() of the characters in the BMP. It depends on the locale, which is
+// set before the terminal encoding, so it is filled again after that.
+#define BMP_SIZE 0x10000
+
+static signed char widthTable[ BMP_SIZE ];
+static bool	   widthTableValid = false;
 
 
 // The default encoding is UTF-8. For real terminals this may be
@@ -41,6 +56,7 @@ NCstring:: NCstring()
 	: hotk( 0 )
 	, hotp( std::wstring::npos )
 	, wstr( L"" )
+	, cols( std::wstring::npos )
 
 {
 }
@@ -50,6 +66,7 @@ NCstring::NCstring( const NCstring & nstr )
 	: hotk( nstr.hotk )
 	, hotp( nstr.hotp )
 	, wstr( nstr.wstr )
+	, cols( nstr.cols )
 {
 }
 
@@ -58,6 +75,7 @@ NCstring::NCstring( const std::wstring & widestr )
 	: hotk( 0 )
 	, hotp( std::wstring::npos )
 	, wstr( widestr )
+	, cols( std::wstring::npos )
 {
 }
 
@@ -65,6 +83,7 @@ NCstring::NCstring( const std::wstring & widestr )
 NCstring::NCstring( const std::string & str )
 	: hotk( 0 )
 	, hotp( std::wstring::npos )
+	, cols( std::wstring::npos )
 {
     bool ok = RecodeToWchar( str, "UTF-8", &wstr );
 
@@ -78,6 +97,7 @@ NCstring::NCstring( const std::string & str )
 NCstring::NCstring( const char * cstr )
 	: hotk( 0 )
 	, hotp( std::wstring::npos )
+	, cols( std::wstring::npos )
 {
     bool ok = RecodeToWchar( cstr, "UTF-8", &wstr );
 
@@ -101,6 +121,7 @@ NCstring & NCstring::operator=( const NCstring & nstr )
 	hotk	  = nstr.hotk;
 	hotp	  = nstr.hotp;
 	wstr	  = nstr.wstr;
+	cols	  = nstr.cols;
     }
 
     return *this;
@@ -110,76 +131,291 @@ NCstring & NCstring::operator=( const NCstring & nstr )
 NCstring & NCstring::operator+=( const NCstring & nstr )
 {
     wstr.append( nstr.wstr );
+    cols = std::wstring::npos;
     return *this;
 }
 
-static iconv_t fromwchar_cd	= ( iconv_t )( -1 );
-static std::string  to_name		= "";
+//
+// Recoding
+//
+// The UI texts are UTF-8 and the wide characters are UCS-4, so the common
+// case is recoded directly without iconv. Other encodings use iconv with
+// handles that are opened once per thread and encoding.
+//
+
+#if defined( __STDC_ISO_10646__ ) && __WCHAR_MAX__ > 0xffff
+#define WCHAR_IS_UCS4 1
+#else
+#define WCHAR_IS_UCS4 0
+#endif
+
+
+/**
+ * The iconv handles of the current thread. iconv handles keep a state, so
+ * they must not be shared between threads.
+ **/
+class IconvCache
+{
+public:
 
+    ~IconvCache()
+    {
+	for ( Handle & handle : _handles )
+	    iconv_close( handle.cd );
+    }
 
+    /**
+     * Return the handle for recoding from 'from' to 'to', open it if
+     * needed. Return ( iconv_t )( -1 ) if the encodings are not supported.
+     **/
+    iconv_t get( const std::string & to, const std::string & from )
+    {
+	for ( Handle & handle : _handles )
+	{
+	    if ( handle.to == to && handle.from == from )
+	    {
+		iconv( handle.cd, 0, 0, 0, 0 );	// reset the state
+		return handle.cd;
+	    }
+	}
 
-bool NCstring::RecodeFromWchar( const std::wstring & in, const std::string & to_encoding, std::string* out )
+	iconv_t cd = iconv_open( to.c_str(), from.c_str() );
+	// yuiDebug() << "iconv_open( " << to << ", " << from << " )" << std::endl;
+
+	if ( cd != ( iconv_t )( -1 ) )
+	    _handles.push_back( { to, from, cd } );
+
+	return cd;
+    }
+
+private:
+
+    struct Handle
+    {
+	std::string to;
+	std::string from;
+	iconv_t	    cd;
+    };
+
+    std::vector<Handle> _handles;
+};
+
+
+static thread_local IconvCache	      iconvCache;
+static thread_local std::vector<char> iconvBuffer;	// reused for the output
+
+
+static bool isUtf8( const std::string & encoding )
 {
-    iconv_t cd = ( iconv_t )( -1 );
-    static bool complained = false;
-    *out = "";
+    return WCHAR_IS_UCS4
+	&& ( strcasecmp( encoding.c_str(), "UTF-8" ) == 0
+	     || strcasecmp( encoding.c_str(), "UTF8" ) == 0 );
+}
 
-    if ( in.length() == 0 )
-	return true;
 
-    // iconv_open not yet called
-    if ( fromwchar_cd == ( iconv_t )( -1 )
-	 || to_name != to_encoding )
+/**
+ * Return true if the 8 bytes at 'ptr' are all ASCII. This checks all of
+ * them at once, which is what makes the fast path fast for the mostly ASCII
+ * texts of the UI.
+ **/
+static inline bool isAscii8( const unsigned char * ptr )
+{
+    uint64_t word;
+    memcpy( &word, ptr, sizeof( word ) );
+
+    return ( word & 0x8080808080808080ULL ) == 0;
+}
+
+
+/**
+ * Recode UTF-8 to UCS-4. Invalid or incomplete sequences are replaced by
+ * a '?' for each byte. Like glibc iconv, this accepts the original UTF-8
+ * with up to 6 bytes and 31 bit characters, only surrogates are invalid.
+ **/
+static bool utf8ToWchar( const std::string & in, std::wstring * out )
+{
+    const unsigned char * ptr = (const unsigned char *) in.data();
+    const unsigned char * end = ptr + in.size();
+    bool ok = true;
+
+    out->resize( in.size() );	// at most one character per byte
+    wchar_t * dest = &( *out )[0];
+
+    while ( ptr < end )
     {
-	if ( fromwchar_cd != ( iconv_t )( -1 ) )
+	while ( end - ptr >= 8 && isAscii8( ptr ) )
+	{
+	    for ( int i = 0; i < 8; i++ )
+		*dest++ = ptr[i];
+
+	    ptr += 8;
+	}
+
+	if ( ptr == end )
+	    break;
+
+	unsigned char ch = *ptr;
+
+	if ( ch < 0x80 )
 	{
-	    iconv_close( fromwchar_cd );
+	    *dest++ = ch;
+	    ptr++;
+	    continue;
 	}
 
-	fromwchar_cd = iconv_open( to_encoding.c_str(), "WCHAR_T" );
+	int	 len;
+	uint32_t code;
+	uint32_t minCode;
 
-	// yuiDebug() << "iconv_open( " << to_encoding.c_str() << ", \"WCHAR_T\" )" << std::endl;
+	if	( ch >= 0xc2 && ch <= 0xdf ) { len = 2; code = ch & 0x1f; minCode = 0x80;	   }
+	else if ( ch >= 0xe0 && ch <= 0xef ) { len = 3; code = ch & 0x0f; minCode = 0x800;	   }
+	else if ( ch >= 0xf0 && ch <= 0xf7 ) { len = 4; code = ch & 0x07; minCode = 0x10000;   }
+	else if ( ch >= 0xf8 && ch <= 0xfb ) { len = 5; code = ch & 0x03; minCode = 0x200000;  }
+	else if ( ch >= 0xfc && ch <= 0xfd ) { len = 6; code = ch & 0x01; minCode = 0x4000000; }
+	else				     { len = 0; code = 0;	  minCode = 0;		   }
 
-	if ( fromwchar_cd == ( iconv_t )( -1 ) )
+	bool valid = len > 0 && end - ptr >= len;
+
+	for ( int i = 1; valid && i < len; i++ )
 	{
-	    if ( !complained )
+	    valid = ( ptr[i] & 0xc0 ) == 0x80;
+	    code  = ( code << 6 ) | ( ptr[i] & 0x3f );
+	}
+
+	valid = valid
+	    && code >= minCode
+	    && ( code < 0xd800 || code > 0xdfff );
+
+	if ( valid )
+	{
+	    *dest++ = code;
+	    ptr += len;
+	}
+	else
+	{
+	    *dest++ = L'?';
+	    ptr++;
+	    ok = false;
+	}
+    }
+
+    out->resize( dest - out->data() );
+
+    return ok;
+}
+
+
+/**
+ * Recode UCS-4 to UTF-8. Surrogates and negative values are replaced by
+ * '?'.
+ **/
+static bool wcharToUtf8( const std::wstring & in, std::string * out )
+{
+    const wchar_t * ptr = in.data();
+    const wchar_t * end = ptr + in.size();
+    bool ok = true;
+
+    out->resize( in.size() * 6 );	// at most 6 bytes per character
+    char * dest = &( *out )[0];
+
+    while ( ptr < end )
+    {
+	uint32_t code = *ptr++;
+
+	if ( code < 0x80 )
+	{
+	    *dest++ = code;
+	}
+	else if ( code < 0x800 )
+	{
+	    *dest++ = 0xc0 | ( code >> 6 );
+	    *dest++ = 0x80 | ( code & 0x3f );
+	}
+	else if ( code < 0x10000 )
+	{
+	    if ( code >= 0xd800 && code <= 0xdfff )
 	    {
-		yuiError() << "ERROR: iconv_open failed" << std::endl;
-		complained = true;
+		*dest++ = '?';
+		ok = false;
+		continue;
 	    }
 
-	    return false;
+	    *dest++ = 0xe0 | ( code >> 12 );
+	    *dest++ = 0x80 | ( ( code >> 6 ) & 0x3f );
+	    *dest++ = 0x80 | ( code & 0x3f );
+	}
+	else if ( code <= 0x7fffffff )
+	{
+	    int len = ( code < 0x200000 ? 4 : code < 0x4000000 ? 5 : 6 );
+
+	    *dest++ = ( 0xff00 >> len ) | ( code >> ( 6 * ( len - 1 ) ) );
+
+	    for ( int shift = 6 * ( len - 2 ); shift >= 0; shift -= 6 )
+		*dest++ = 0x80 | ( ( code >> shift ) & 0x3f );
 	}
 	else
 	{
-	    to_name = to_encoding;
+	    *dest++ = '?';
+	    ok = false;
+	}
+    }
+
+    out->resize( dest - out->data() );
+
+    return ok;
+}
+
+
+bool NCstring::RecodeFromWchar( const std::wstring & in, const std::string & to_encoding, std::string* out )
+{
+    static bool complained = false;
+
+    *out = "";
+
+    if ( in.length() == 0 )
+	return true;
+
+    if ( isUtf8( to_encoding ) )
+    {
+	if ( !wcharToUtf8( in, out ) && !complained )
+	{
+	    yuiError() << "ERROR: invalid wide character" << std::endl;
+	    complained = true;
 	}
+
+	return true;
     }
 
-    cd = fromwchar_cd;		// set iconv handle
+    iconv_t cd = iconvCache.get( to_encoding, "WCHAR_T" );
+
+    if ( cd == ( iconv_t )( -1 ) )
+    {
+	if ( !complained )
+	{
+	    yuiError() << "ERROR: iconv_open failed" << std::endl;
+	    complained = true;
+	}
+
+	return false;
+    }
 
     size_t in_len = in.length() * sizeof( std::wstring::value_type );	// number of in bytes
     char* in_ptr = (char *) in.data();
 
-    size_t tmp_size = ( in_len * sizeof( char ) ) * 2;
     // tmp buffer size: in_len bytes * 2, that means 1 wide charatcer (4 Byte) can be transformed
     // into an encoding which needs at most 8 Byte for one character (should be enough)
-
-    char* tmp = (char *) malloc( tmp_size + sizeof( char ) );
+    iconvBuffer.resize( std::max( iconvBuffer.size(), in_len * 2 ) );
 
     do
     {
-
-	char *tmp_ptr = tmp;
-	size_t tmp_len = tmp_size;
-	*( (char *) tmp_ptr ) = '\0';
+	char *tmp_ptr = iconvBuffer.data();
+	size_t tmp_len = iconvBuffer.size();
 
 	size_t iconv_ret = iconv( cd, &in_ptr, &in_len, &tmp_ptr, &tmp_len );
 
-	*( (char *) tmp_ptr ) = '\0';
-	*out += std::string( tmp );
+	out->append( iconvBuffer.data(), tmp_ptr - iconvBuffer.data() );
 
-	if ( iconv_ret == ( size_t )( -1 ) )
+	if ( iconv_ret == ( size_t )( -1 ) && errno != E2BIG )
 	{
 	    if ( !complained )
 	    {
@@ -193,88 +429,69 @@ bool NCstring::RecodeFromWchar( const std::wstring & in, const std::string & to_
 	    }
 
 	    in_ptr += sizeof( std::wstring::value_type );
-
 	    in_len -= sizeof( std::wstring::value_type );
 	}
-
     }
     while ( in_len != 0 );
 
-    free( tmp );
-
     return true;
 }
 
-static iconv_t towchar_cd	= ( iconv_t )( -1 );
-static std::string  from_name	= "";
-
-
 
 bool NCstring::RecodeToWchar( const std::string& in, const std::string &from_encoding, std::wstring* out )
 {
-    iconv_t cd = ( iconv_t )( -1 );
     static bool complained = false;
+
     *out = L"";
 
     if ( in.length() == 0 )
 	return true;
 
-    // iconv_open not yet called
-    if ( towchar_cd == ( iconv_t )( -1 )
-	 || from_name != from_encoding )
+    if ( isUtf8( from_encoding ) )
     {
-	if ( towchar_cd != ( iconv_t )( -1 ) )
+	if ( !utf8ToWchar( in, out ) && !complained )
 	{
-	    iconv_close( towchar_cd );
+	    yuiError() << "ERROR: invalid UTF-8 string" << std::endl;
+	    complained = true;
 	}
 
-	towchar_cd = iconv_open( "WCHAR_T", from_encoding.c_str() );
-
-	// yuiDebug() << "iconv_open( \"WCHAR_T\", " << from_encoding.c_str() << " )" << std::endl;
+	return true;
+    }
 
-	if ( towchar_cd == ( iconv_t )( -1 ) )
-	{
-	    if ( !complained )
-	    {
-		yuiError() << "Error: RecodeToWchar iconv_open() failed" << std::endl;
-		complained = true;
-	    }
+    iconv_t cd = iconvCache.get( "WCHAR_T", from_encoding );
 
-	    return false;
-	}
-	else
+    if ( cd == ( iconv_t )( -1 ) )
+    {
+	if ( !complained )
 	{
-	    from_name = from_encoding;
+	    yuiError() << "Error: RecodeToWchar iconv_open() failed" << std::endl;
+	    complained = true;
 	}
-    }
 
-    cd = towchar_cd;		// set iconv handle
+	return false;
+    }
 
     size_t in_len = in.length();		// number of bytes of input std::string
     char* in_ptr = const_cast <char*>( in.c_str() );
 
-    size_t tmp_size = in_len * sizeof( wchar_t );	// buffer size: at most in_len wide characters
-    char* tmp = (char*) malloc( tmp_size + sizeof( wchar_t ) );		// + L'\0'
+    // buffer size: at most in_len wide characters
+    iconvBuffer.resize( std::max( iconvBuffer.size(), in_len * sizeof( wchar_t ) ) );
 
     do
     {
-
-	size_t tmp_len = tmp_size;
-	char* tmp_ptr = tmp;
+	size_t tmp_len = iconvBuffer.size();
+	char* tmp_ptr = iconvBuffer.data();
 
 	size_t iconv_ret = iconv( cd, &in_ptr, &in_len, &tmp_ptr, &tmp_len );
 
-	*( (wchar_t *) tmp_ptr ) = L'\0';
+	out->append( (wchar_t *) iconvBuffer.data(), ( tmp_ptr - iconvBuffer.data() ) / sizeof( wchar_t ) );
 
-	*out += std::wstring( (wchar_t *) tmp );
-
-	if ( iconv_ret == ( size_t )( -1 ) )
+	if ( iconv_ret == ( size_t )( -1 ) && errno != E2BIG )
 	{
 	    if ( !complained )
 	    {
 		// EILSEQ	84	Illegal byte sequence.
 		// EINVAL	22	Invalid argument
-		// E2BIG	7	Argument list too long
 		yuiError() << "ERROR iconv: " << errno << std::endl;
 		complained = true;
 	    }
@@ -285,15 +502,11 @@ bool NCstring::RecodeToWchar( const std::string& in, const std::string &from_enc
 	    }
 
 	    in_ptr++;
-
 	    in_len--;
 	}
-
     }
     while ( in_len != 0 );
 
-    free( tmp );
-
     return true;
 }
 
@@ -353,6 +566,7 @@ void NCstring::getHotkey() const
     }
 
     wstr = newstr;
+    cols = std::wstring::npos;
 
     std::wstring::size_type tpos = wstr.find_first_of( replacementShortcutMarker );
 
@@ -361,7 +575,7 @@ void NCstring::getHotkey() const
 	size_t realpos = 0, t;
 
 	for ( t = 0; t < tpos; t++ )
-	    realpos += wcwidth( wstr[t] );
+	    realpos += charWidth( wstr[t] );
 
 	wstr.erase( tpos, 1 );
 
@@ -376,6 +590,8 @@ void NCstring::getHotkey() const
 
 bool NCstring::setTerminalEncoding( const std::string & encoding )
 {
+    widthTableValid = false;	// the locale was set before
+
     if ( termEncoding != encoding )
     {
 	yuiMilestone() << "Terminal encoding set to: " << encoding << std::endl;
@@ -387,3 +603,44 @@ bool NCstring::setTerminalEncoding( const std::string & encoding )
 	return false;
     }
 }
+
+
+size_t NCstring::width() const
+{
+    if ( cols == std::wstring::npos )
+    {
+	cols = 0;
+
+	for ( wchar_t ch : wstr )
+	{
+	    int chwidth = charWidth( ch );
+
+	    if ( chwidth > 0 )
+		cols += chwidth;
+	    else if ( ch == L'\t' )
+		cols += NCurses::tabsize();
+	}
+    }
+
+    return cols;
+}
+
+
+int NCstring::charWidth( wchar_t ch )
+{
+    if ( (unsigned long) ch < BMP_SIZE )
+    {
+	if ( !widthTableValid )
+	{
+	    for ( unsigned i = 0; i < BMP_SIZE; i++ )
+		widthTable[i] = wcwidth( i );
+
+	    widthTableValid = true;
+	}
+
+	return widthTable[ ch ];
+    }
+
+    return wcwidth( ch );
+}
+
@@ -46,6 +46,8 @@ private:
     ///its wchar_t offset is 2 (and its UTF-8 offset is 4).
     mutable std::wstring::size_type hotp;
     mutable std::wstring   wstr;	  ///< the actual string
+    /// Display width in columns, calculated on demand; *npos* if not yet.
+    mutable std::wstring::size_type cols;
 
     /// The encoding of the terminal; the value is ignored by this class.
     /// WTF, really: other classes care
@@ -79,6 +81,10 @@ public:
 
     const std::wstring & str()      const { return wstr; }
 
+    /// The number of columns needed to display the string: Non-printable
+    /// characters take none, tabs NCurses::tabsize(). Calculated only once.
+    size_t width() const;
+
 private:
 
     friend class NClabel;
@@ -98,6 +104,10 @@ public:
 
     static bool setTerminalEncoding( const std::string & encoding = "" );
 
+    /// The number of columns of character *ch* on the screen like
+    /// wcwidth(), but looked up in a table for the BMP.
+    static int charWidth( wchar_t ch );
+
     /// (mutates the const object)
     void getHotkey() const;
 };
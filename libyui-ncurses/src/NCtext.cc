@@ -27,7 +27,7 @@
 #include "NCtext.h"
 #include "stringutil.h"
 
-#include <wchar.h>		// wcwidth
+#include <algorithm>
 #include <langinfo.h>
 
 #include <boost/algorithm/string.hpp>
@@ -38,6 +38,7 @@ const NCstring NCtext::emptyStr;
 
 
 NCtext::NCtext( const NCstring & nstr )
+    : mcolumns( std::string::npos )
 {
     lset( nstr );
 }
@@ -45,6 +46,7 @@ NCtext::NCtext( const NCstring & nstr )
 
 
 NCtext::NCtext( const NCstring & nstr, size_t columns )
+    : mcolumns( std::string::npos )
 {
     lbrset( nstr, columns );
 }
@@ -61,6 +63,7 @@ void NCtext::lset( const NCstring & ntext )
     // FIXME: rewrite this function so one understands it
 
     mtext.clear();
+    mcolumns = std::string::npos;
     mtext.push_back( "" );
 
     if ( ntext.str().empty() )
@@ -103,6 +106,7 @@ void NCtext::lset( const NCstring & ntext )
 void NCtext::lbrset( const NCstring & ntext, size_t columns )
 {
     mtext.clear();
+    mcolumns = std::string::npos;
 
     if ( ntext.str().empty() )
 	return;
@@ -167,35 +171,22 @@ unsigned NCtext::Lines() const
 void NCtext::append( const NCstring &line )
 {
     mtext.push_back( line );
+    mcolumns = std::string::npos;
 }
 
 
 
 size_t NCtext::Columns() const
 {
-    size_t llen = 0;		// longest line
-    size_t tmp_len = 0;		// width of current line
-
-    const_iterator line;		// iterator for list <NCstring> mtext
-    std::wstring::const_iterator wstr_it;	// iterator for std::wstring
-
-    for ( line = mtext.begin(); line != mtext.end(); ++line )
+    if ( mcolumns == std::string::npos )
     {
-	tmp_len = 0;
-
-	for ( wstr_it = ( *line ).str().begin(); wstr_it != ( *line ).str().end() ; ++wstr_it )
-	{
-	    if ( iswprint( *wstr_it ) )
-		tmp_len += wcwidth( *wstr_it );
-	    else if ( *wstr_it == L'\t' )
-		tmp_len += NCurses::tabsize();
-	}
+	mcolumns = 0;		// longest line
 
-	if ( tmp_len > llen )
-	    llen = tmp_len;
+	for ( const NCstring & line : mtext )
+	    mcolumns = std::max( mcolumns, line.width() );
     }
 
-    return llen;
+    return mcolumns;
 }
 
 
@@ -226,6 +217,7 @@ std::ostream & operator<<( std::ostream & str, const NCtext & obj )
 void NClabel::stripHotkey()
 {
     hotline = std::wstring::npos;
+    mcolumns = std::string::npos;	// the lines change
     unsigned lineno = 0;
 
     for ( iterator line = mtext.begin(); line != mtext.end(); ++line, ++lineno )
@@ -52,6 +52,10 @@ protected:
 
     std::list<NCstring> mtext;
 
+    /// The width of the longest line, calculated on demand. Set it to
+    /// *npos* when changing mtext.
+    mutable size_t mcolumns;
+
     virtual void lset( const NCstring & ntext );
     void lbrset( const NCstring & ntext, size_t columns );
 
@@ -25,6 +25,7 @@
 #include <unistd.h>
 #include <string.h>	// strcmp(), strerror()
 
+#include <chrono>
 #include <cstdarg>
 #include <fstream>
 #include <list>
@@ -34,6 +35,7 @@
 #include <yui/YUILog.h>
 #include "NCurses.h"
 #include "NCDialog.h"
+#include "NCTimer.h"
 
 #include "stdutil.h"
 #include <signal.h>
@@ -48,6 +50,18 @@ using stdutil::form;
 
 NCurses * NCurses::myself = 0;
 std::set<NCDialog*> NCurses::_knownDlgs;
+int NCurses::_updateBatches = 0;
+bool NCurses::_updatePending = false;
+NCurses::OutputStats NCurses::_outputStats = { 0, 0, 0, 0.0 };
+
+// Settings from Y2NCURSES_UPDATE_INTERVAL and Y2NCURSES_STATS
+static std::chrono::milliseconds updateInterval( 0 );
+static bool countOutputBytes = false;
+
+static std::chrono::steady_clock::time_point lastFrame;
+
+// Sends a deferred update once the update interval has passed
+static NCTimer * updateTimer = 0;
 const NCursesEvent NCursesEvent::Activated( NCursesEvent::button, YEvent::Activated );
 const NCursesEvent NCursesEvent::SelectionChanged( NCursesEvent::button, YEvent::SelectionChanged );
 const NCursesEvent NCursesEvent::ValueChanged( NCursesEvent::button, YEvent::ValueChanged );
@@ -125,8 +139,66 @@ std::ostream & operator<<( std::ostream & str, const NCursesEvent & obj )
 
 
 
+/**
+ * Return the number of bytes this thread has written so far or 0 if not
+ * counting. Around a screen update this is what ncurses sent to the
+ * terminal.
+ **/
+static unsigned long long bytesWritten()
+{
+    if ( ! countOutputBytes )
+	return 0;
+
+    std::ifstream io( "/proc/thread-self/io" );
+    std::string key;
+    unsigned long long value;
+
+    while ( io >> key >> value )
+    {
+	if ( key == "wchar:" )
+	    return value;
+    }
+
+    return 0;
+}
+
+
+/**
+ * Add the time and the output of a screen update to the output statistics.
+ **/
+class OutputMeter
+{
+public:
+
+    OutputMeter( NCurses::OutputStats & stats )
+	: _stats( stats )
+	, _start( std::chrono::steady_clock::now() )
+	, _bytes( bytesWritten() )
+    {}
+
+    ~OutputMeter()
+    {
+	lastFrame = std::chrono::steady_clock::now();
+
+	std::chrono::duration<double, std::milli> elapsed = lastFrame - _start;
+
+	_stats.frames++;
+	_stats.millisec += elapsed.count();
+	_stats.bytes	+= bytesWritten() - _bytes;
+    }
+
+private:
+
+    NCurses::OutputStats &		  _stats;
+    std::chrono::steady_clock::time_point _start;
+    unsigned long long			  _bytes;
+};
+
+
+
 NCurses::NCurses()
 	: theTerm( 0 )
+	, inputFd( 0 )
 	, title_w( 0 )
 	, status_w( 0 )
 	, styleset( 0 )
@@ -143,8 +215,17 @@ NCurses::NCurses()
 NCurses::~NCurses()
 {
     yuiMilestone() << "Shutdown NCurses..." << std::endl;
+    yuiMilestone() << "Terminal output: "
+		   << _outputStats.updates << " updates, "
+		   << _outputStats.frames << " frames, "
+		   << ( countOutputBytes ? std::to_string( _outputStats.bytes ) : std::string( "?" ) ) << " bytes, "
+		   << (long) _outputStats.millisec << " ms"
+		   << std::endl;
     myself = 0;
 
+    delete updateTimer;
+    updateTimer = 0;
+
     //restore env. variable - might have been changed by NCurses::init()
     setenv( "TERM", envTerm.c_str(), 1 );
     delete styleset;
@@ -194,6 +275,18 @@ void NCurses::init()
 
     signal( SIGINT, SIG_IGN );	// ignore Ctrl C
 
+    const char * interval = getenv( "Y2NCURSES_UPDATE_INTERVAL" );
+
+    if ( interval && atoi( interval ) > 0 )
+    {
+	updateInterval = std::chrono::milliseconds( atoi( interval ) );
+	updateTimer = new NCTimer( atoi( interval ),
+				   []() { if ( _updateBatches == 0 ) FlushUpdate(); } );
+	yuiMilestone() << "Screen updates at most every " << updateInterval.count() << " ms" << std::endl;
+    }
+
+    countOutputBytes = getenv( "Y2NCURSES_STATS" ) != NULL;
+
     //rip off the top line
 
     if ( title_line() && ::ripoffline( 1, ripinit_top ) != OK )
@@ -261,7 +354,8 @@ void NCurses::init()
 		if ( set_term( theTerm ) == NULL )
 		    throw NCursesError( "set_term() failed" );
 
-		myTerm = mytty;
+		myTerm  = mytty;
+		inputFd = fileno( fdi );
 	    }
 	}
     }
@@ -416,12 +510,41 @@ void NCurses::Update()
 {
     if ( myself && myself->initialized() )
     {
-	//myself->stdpan->refresh();
-	myself->stdpan->redraw();
+	_outputStats.updates++;
+	_updatePending = true;
+
+	if ( _updateBatches == 0 )
+	    FlushUpdate();
     }
 }
 
 
+void NCurses::FlushUpdate()
+{
+    if ( !_updatePending || !myself || !myself->initialized() )
+	return;
+
+    if ( std::chrono::steady_clock::now() - lastFrame >= updateInterval )
+	sendUpdate();
+    else if ( updateTimer && !updateTimer->active() )
+	updateTimer->start();	// send it when the interval has passed
+}
+
+
+void NCurses::sendUpdate()
+{
+    OutputMeter meter( _outputStats );
+    _updatePending = false;
+
+    if ( updateTimer )
+	updateTimer->stop();
+
+    // Only the lines changed since the last update are copied to the
+    // screen; see NCursesPanel::update()
+    NCursesPanel::update();
+}
+
+
 void NCurses::Refresh()
 {
     if ( myself && myself->initialized() )
@@ -429,8 +552,15 @@ void NCurses::Refresh()
 	yuiDebug() << "start refresh ..." << std::endl;
 	SetTitle( myself->title_t );
 	SetStatusLine( myself->status_line );
+	// Repaint the whole terminal, not just what changed: The terminal
+	// contents might be garbled
 	::clearok( ::stdscr, true );
-	myself->stdpan->refresh();
+
+	{
+	    OutputMeter meter( _outputStats );
+	    myself->stdpan->refresh();
+	}
+
 	yuiDebug() << "done refresh ..." << std::endl;
     }
 }
@@ -457,8 +587,15 @@ void NCurses::Redraw()
 	    pan = ::panel_above( pan );
 	}
 
-	// TBD: initialize all dialogs rewdraw
-	Refresh();
+	// No need to clear the screen: ncurses will only send what actually
+	// changed in the redrawn dialogs
+	SetTitle( myself->title_t );
+	SetStatusLine( myself->status_line );
+
+	{
+	    OutputMeter meter( _outputStats );
+	    myself->stdpan->redraw();
+	}
 
 	yuiDebug() << "done redraw ..." << std::endl;
     }
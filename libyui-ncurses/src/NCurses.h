@@ -160,6 +160,7 @@ private:
 protected:
 
     SCREEN *	theTerm;
+    int		inputFd;	// the fd ncurses reads the keyboard input from
     std::string	myTerm;
     std::string	envTerm;
     WINDOW *	title_w;
@@ -196,14 +197,71 @@ public:
 
     static int tabsize() { return ::TABSIZE; }
 
+    /**
+     * Return the file descriptor of the terminal input, e.g. to poll() it.
+     **/
+    static int inputFileDescriptor() { return myself ? myself->inputFd : 0; }
+
     void run();
 
 public:
 
     static const NCstyle & style();
 
+    /**
+     * Send the changes of all dialogs to the terminal.
+     *
+     * This is deferred inside an UpdateBatch and, if the environment
+     * variable Y2NCURSES_UPDATE_INTERVAL is set to a number of
+     * milliseconds, if the last update was sent less than that ago. This
+     * avoids flooding slow terminals (e.g. serial consoles) with
+     * intermediate states like quickly changing progress bars.
+     **/
     static void Update();
+
+    /**
+     * Send a deferred Update() to the terminal. If the update interval has
+     * not passed yet, it is sent as soon as it has: by an NCTimer while
+     * waiting for input or by the next call of this. Call this before
+     * waiting for input.
+     **/
+    static void FlushUpdate();
+
+    /**
+     * Defer NCurses::Update() while an instance exists. Destroying the
+     * outermost one sends the changes to the terminal (respecting the
+     * update interval), so e.g. handling a key press results in only one
+     * screen update.
+     **/
+    class UpdateBatch
+    {
+    public:
+	UpdateBatch()	{ _updateBatches++; }
+	~UpdateBatch()	{ if ( --_updateBatches == 0 ) FlushUpdate(); }
+    };
+
+    /**
+     * Statistics of the terminal output. They are logged on shutdown.
+     **/
+    struct OutputStats
+    {
+	unsigned long	   updates;	///< Update() calls
+	unsigned long	   frames;	///< screen updates sent to the terminal
+	unsigned long long bytes;	///< bytes sent; only with Y2NCURSES_STATS set
+	double		   millisec;	///< time spent sending the screen updates
+    };
+
+    static const OutputStats & outputStats() { return _outputStats; }
+
+    /**
+     * Redraw all dialogs, e.g. after a style change.
+     **/
     static void Redraw();
+
+    /**
+     * Repaint the whole terminal. This is expensive on slow terminal
+     * connections; use it only if the terminal contents might be garbled.
+     **/
     static void Refresh();
     static void SetTitle( const std::string & str );
     static void SetStatusLine( std::map <int, NCstring> fkeys );
@@ -220,6 +278,12 @@ public:
 
 private:
     static std::set<NCDialog*> _knownDlgs;
+
+    static void sendUpdate();
+
+    static int		_updateBatches;
+    static bool		_updatePending;
+    static OutputStats	_outputStats;
 };
 
 
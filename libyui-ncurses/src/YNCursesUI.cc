@@ -46,6 +46,7 @@ textdomain "ncurses"
 #include "NCOptionalWidgetFactory.h"
 #include "NCPackageSelectorPluginStub.h"
 #include "NCPopupTextEntry.h"
+#include "NCTimer.h"
 #include "NCi18n.h"
 
 extern std::string language2encoding( std::string lang );
@@ -164,46 +165,46 @@ void YNCursesUI::idleLoop( int fd_ycp )
     struct timeval tv;
     fd_set fdset;
     int	   retval;
+    int	   select_errno;
+    bool   interrupted;
 
     do
     {
-	tv.tv_sec  = timeout;
-	tv.tv_usec = 0;
+	// wake up for the NCTimers (e.g. busy indicator animations), too
+	int wait = NCTimer::waitTime( timeout * 1000 );
+	tv.tv_sec  = wait / 1000;
+	tv.tv_usec = ( wait % 1000 ) * 1000;
 
 	FD_ZERO( &fdset );
 	FD_SET( 0,	&fdset );
 	FD_SET( fd_ycp, &fdset );
 
 	retval = select( fd_ycp + 1, &fdset, 0, 0, &tv );
+	select_errno = errno;	// the timers might change errno
+	interrupted = retval < 0 && select_errno == EINTR;
+
+	//do not throw here, as current dialog may not necessarily exist yet
+	//if we have threads
+	NCDialog * ncd = static_cast<NCDialog *>( YDialog::currentDialog( false ) );
+
+	if ( ncd )
+	    ncd->runTimers();
+	else
+	    NCTimer::runDueTimers();
 
 	if ( retval < 0 )
 	{
-	    if ( errno != EINTR )
-		yuiError() << "idleLoop error in select() (" << errno << ')' << std::endl;
+	    if ( !interrupted )
+		yuiError() << "idleLoop error in select() (" << select_errno << ')' << std::endl;
 	}
 	else if ( retval != 0 && idle_loop_enabled )
 	{
-	    //do not throw here, as current dialog may not necessarily exist yet
-	    //if we have threads
-	    YDialog *currentDialog = YDialog::currentDialog( false );
-
-	    if ( currentDialog )
-	    {
-		NCDialog * ncd = static_cast<NCDialog *>( currentDialog );
-
-		if ( ncd )
-		{
-		    extern NCBusyIndicator* NCBusyIndicatorObject;
-
-		    if ( NCBusyIndicatorObject )
-			NCBusyIndicatorObject->handler( 0 );
-
-		    ncd->idleInput();
-		}
-	    }
+	    if ( ncd )
+		ncd->idleInput();
 	} // else no input within timeout sec.
     }
-    while ( !FD_ISSET( fd_ycp, &fdset ) );
+    // retry after a signal, but give up on other errors
+    while ( interrupted || ( retval >= 0 && !FD_ISSET( fd_ycp, &fdset ) ) );
 }
 
 
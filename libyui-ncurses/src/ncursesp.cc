@@ -108,6 +108,30 @@ NCursesPanel::redraw()
     ::doupdate();
 }
 
+void
+NCursesPanel::update()
+{
+    PANEL *pan;
+
+    pan = ::panel_above( NULL );
+
+    while ( pan )
+    {
+	NCursesPanel * panel = const_cast<NCursesPanel *>( get_Panel_of( *pan ) );
+
+	if ( panel )
+	    panel->syncupSubwins();
+	else
+	    ::touchwin( panel_window( pan ) );
+
+	pan = ::panel_above( pan );
+    }
+
+    ::update_panels();
+
+    ::doupdate();
+}
+
 int
 NCursesPanel::refresh()
 {
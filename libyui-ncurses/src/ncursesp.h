@@ -251,6 +251,13 @@ public:
      */
     static void redraw();
 
+    /**
+     * Update the screen with the changes of all panels, including the
+     * changes made in their subwindows. Unlike redraw(), this does not
+     * touch unchanged lines.
+     */
+    static void update();
+
     // decorations
     /**
      * Put a frame around the panel and put the title centered in the top line
@@ -106,13 +106,14 @@ NCursesWindow::printw( int y, int x, const char * fmt, ... )
 int
 NCursesWindow::addwstr( int y, int x, const wchar_t * str, int n )
 {
-    const std::wstring wstr( str );
-    std::string out;
-
     if ( NCstring::terminalEncoding() != "UTF-8" )
     {
+	// only copy the 'n' characters to add, 'str' might be much longer
+	const std::wstring wstr( str, n < 0 ? wcslen( str ) : n );
+	std::string out;
+
 	NCstring::RecodeFromWchar( wstr, NCstring::terminalEncoding(), &out );
-	return ::mvwaddnstr( w, y, x, out.c_str(), n );
+	return ::mvwaddnstr( w, y, x, out.c_str(), -1 );
     }
     else
 	return ::mvwaddnwstr( w, y, x, (wchar_t *) str, n );
@@ -123,13 +124,13 @@ NCursesWindow::addwstr( int y, int x, const wchar_t * str, int n )
 int
 NCursesWindow::addwstr( const wchar_t* str, int n )
 {
-    const std::wstring wstr( str );
-    std::string out;
-
     if ( NCstring::terminalEncoding() != "UTF-8" )
     {
+	const std::wstring wstr( str, n < 0 ? wcslen( str ) : n );
+	std::string out;
+
 	NCstring::RecodeFromWchar( wstr, NCstring::terminalEncoding(), &out );
-	return ::waddnstr( w, out.c_str(), n );
+	return ::waddnstr( w, out.c_str(), -1 );
     }
     else
 	return ::waddnwstr( w, (wchar_t *) str, n );
@@ -449,6 +450,21 @@ NCursesWindow::kill_subwindows()
 }
 
 
+void
+NCursesWindow::syncupSubwins()
+{
+    for ( NCursesWindow* p = subwins; p != 0; p = p->sib )
+    {
+	if ( p->w == 0 )
+	    continue;
+
+	p->syncupSubwins();
+	p->syncup();
+	p->untouchwin();
+    }
+}
+
+
 NCursesWindow::~NCursesWindow()
 {
     kill_subwindows();
@@ -1649,6 +1649,13 @@ public:
     */
     void	   syncup()    { ::wsyncup( w ); }
 
+    /**
+     * Propagate the changes of all descendant windows up to this window and
+     * mark the descendant windows as unmodified, so each change is
+     * propagated only once.
+    */
+    void	   syncupSubwins();
+
     /**
      * Position the cursor in all ancestor windows corresponding to our setting
     */
@@ -16,6 +16,7 @@
 
 #include <QThread>
 #include <QSocketNotifier>
+#include <QTimer>
 
 #define  YUILogComponent "qt-rest-api"
 #include <yui/YUILog.h>
@@ -89,7 +90,11 @@ extern YUI * createYQHttpUI( bool withThreads )
 
 YQHttpUISignalReceiver::YQHttpUISignalReceiver()
     : YQUISignalReceiver()
+    , _http_timer( new QTimer( this ) )
 {
+    _http_timer->setSingleShot( true );
+    QObject::connect( _http_timer,  &pclass(_http_timer)::timeout,
+        this, &pclass(this)::httpData);
 }
 
 void
@@ -151,4 +156,13 @@ void YQHttpUISignalReceiver::createHttpNotifiers()
             this, &pclass(this)::httpData);
         _http_notifiers.push_back(_notifier);
     }
+
+    // the server might need to run even if none of its FDs gets ready
+    // (e.g. to continue a partial write in the MHD epoll mode)
+    int timeout = YHttpServer::yserver()->timeout();
+
+    if ( timeout >= 0 )
+        _http_timer->start( timeout );
+    else
+        _http_timer->stop();
 }
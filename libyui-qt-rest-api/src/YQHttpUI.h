@@ -35,6 +35,7 @@
 #define pclass(ptr) std::remove_reference<decltype(*ptr)>::type
 
 class QSocketNotifier;
+class QTimer;
 class YQHttpUISignalReceiver;
 
 
@@ -83,6 +84,8 @@ public:
 
 private:
     std::vector<QSocketNotifier*>  _http_notifiers;
+    // runs the HTTP server when its timeout expires (owned by this object)
+    QTimer * _http_timer;
 };
 
 /**
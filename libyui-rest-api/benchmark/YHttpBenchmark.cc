@@ -0,0 +1,704 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+/*
+ * Load testing and latency benchmark for the REST API.
+ *
+ * Starts the YHttpServer against a headless dialog (no UI plugin is loaded)
+ * and replays a mix of /v1/widgets, /v1/dialog and widget action requests
+ * from local HTTP clients running in separate threads. The main thread
+ * drives the server the same way the UI event loop does, so the requests
+ * are processed sequentially like in a real application.
+ *
+ * Usage:
+ *
+ *   yui-rest-api-benchmark [--buttons N] [--rows N] [--columns N]
+ *                          [--tree N] [--requests N] [--concurrency N]
+ *                          [--mix widgets:W,dialog:D,action:A]
+ *                          [--port N] [--gzip] [--quiet] [--log FILE]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define YUILogComponent "rest-api-benchmark"
+#include <yui/YUILog.h>
+
+#include <yui/YApplication.h>
+#include <yui/YDialog.h>
+#include <yui/YLayoutBox.h>
+#include <yui/YPushButton.h>
+#include <yui/YTable.h>
+#include <yui/YTableHeader.h>
+#include <yui/YTableItem.h>
+#include <yui/YTree.h>
+#include <yui/YTreeItem.h>
+#include <yui/YUI.h>
+#include <yui/YWidgetID.h>
+
+#include "YHttpServer.h"
+
+using std::string;
+using std::vector;
+
+typedef std::chrono::steady_clock Clock;
+
+
+//
+// Headless UI and widgets, just enough to build a widget tree for the server
+//
+
+class BenchApplication : public YApplication
+{
+public:
+    virtual std::string askForExistingDirectory( const string &, const string & )                 { return ""; }
+    virtual std::string askForExistingFile( const string &, const string &, const string & )      { return ""; }
+    virtual std::string askForSaveFileName( const string &, const string &, const string & )      { return ""; }
+
+    virtual int  displayWidth()                 { return 80; }
+    virtual int  displayHeight()                { return 25; }
+    virtual int  displayDepth()                 { return 1; }
+    virtual long displayColors()                { return 8; }
+    virtual int  defaultWidth()                 { return 80; }
+    virtual int  defaultHeight()                { return 25; }
+    virtual bool isTextMode()                   { return true; }
+    virtual bool hasImageSupport()              { return false; }
+    virtual bool hasIconSupport()               { return false; }
+    virtual bool hasAnimationSupport()          { return false; }
+    virtual bool hasFullUtf8Support()           { return true; }
+    virtual bool richTextSupportsTable()        { return false; }
+    virtual bool leftHandedMouse()              { return false; }
+};
+
+
+class BenchUI : public YUI
+{
+public:
+    BenchUI() : YUI( false ) {}
+
+protected:
+    virtual YWidgetFactory *         createWidgetFactory()         { return nullptr; }
+    virtual YOptionalWidgetFactory * createOptionalWidgetFactory() { return nullptr; }
+    virtual YApplication *           createApplication()           { return new BenchApplication(); }
+    virtual YEvent *                 runPkgSelection( YWidget * )  { return nullptr; }
+    virtual void                     idleLoop( int )               {}
+};
+
+
+class BenchDialog : public YDialog
+{
+public:
+    BenchDialog() : YDialog( YMainDialog ) {}
+
+    virtual int  preferredWidth()              { return 80; }
+    virtual int  preferredHeight()             { return 25; }
+    virtual void setSize( int, int )           {}
+    virtual void activate()                    {}
+
+protected:
+    virtual void     openInternal()            {}
+    virtual YEvent * waitForEventInternal( int ) { return nullptr; }
+    virtual YEvent * pollEventInternal()       { return nullptr; }
+};
+
+
+class BenchVBox : public YLayoutBox
+{
+public:
+    BenchVBox( YWidget * parent ) : YLayoutBox( parent, YD_VERT ) {}
+
+    virtual void moveChild( YWidget *, int, int ) {}
+};
+
+
+class BenchPushButton : public YPushButton
+{
+public:
+    BenchPushButton( YWidget * parent, const string & label )
+        : YPushButton( parent, label ) {}
+
+    virtual int  preferredWidth()              { return 10; }
+    virtual int  preferredHeight()             { return 1; }
+    virtual void setSize( int, int )           {}
+    virtual void activate()                    {}
+};
+
+
+class BenchTable : public YTable
+{
+public:
+    BenchTable( YWidget * parent, YTableHeader * header )
+        : YTable( parent, header, false ) {}
+
+    virtual int  preferredWidth()              { return 80; }
+    virtual int  preferredHeight()             { return 10; }
+    virtual void setSize( int, int )           {}
+    virtual void cellChanged( const YTableCell * ) {}
+};
+
+
+class BenchTree : public YTree
+{
+public:
+    BenchTree( YWidget * parent, const string & label )
+        : YTree( parent, label, false, false ) {}
+
+    virtual int  preferredWidth()              { return 40; }
+    virtual int  preferredHeight()             { return 10; }
+    virtual void setSize( int, int )           {}
+    virtual void rebuildTree()                 {}
+    virtual YTreeItem * currentItem()          { return dynamic_cast<YTreeItem *>( selectedItem() ); }
+    virtual void activate()                    {}
+};
+
+
+//
+// Benchmark configuration and results
+//
+
+struct BenchOptions
+{
+    int buttons     = 10;
+    int rows        = 1000;
+    int columns     = 4;
+    int tree        = 100;
+    int requests    = 10000;
+    int concurrency = 4;
+    int port        = 14155;
+    bool gzip       = false;
+    bool quiet      = false;
+    string log      = "/dev/null";
+    // weights of the request kinds (widgets, dialog, action)
+    int mix[3]      = { 4, 1, 2 };
+};
+
+enum RequestKind { WidgetsRequest = 0, DialogRequest, ActionRequest, RequestKinds };
+
+static const char * kind_names[] = { "widgets", "dialog", "action" };
+
+struct Sample
+{
+    RequestKind kind;
+    double      latency_ms;
+    size_t      bytes;
+    bool        ok;
+};
+
+
+static void usage( const char * prog )
+{
+    std::cerr << "Usage: " << prog << " [options]\n\n"
+              << "  --buttons N       number of push buttons in the dialog\n"
+              << "  --rows N          number of table rows\n"
+              << "  --columns N       number of table columns\n"
+              << "  --tree N          number of toplevel tree items (each has 2 children)\n"
+              << "  --requests N      total number of requests\n"
+              << "  --concurrency N   number of parallel client connections\n"
+              << "  --mix W,D,A       weights of the widgets, dialog and action requests,\n"
+              << "                    e.g. widgets:4,dialog:1,action:2\n"
+              << "  --port N          port number for the HTTP server\n"
+              << "  --gzip            request gzip compressed responses\n"
+              << "  --quiet           do not log each request (low overhead mode)\n"
+              << "  --log FILE        libyui log file (default /dev/null)\n";
+    exit( 1 );
+}
+
+
+static void parse_mix( const string & value, BenchOptions & opts )
+{
+    std::istringstream input( value );
+    string token;
+    int index = 0;
+
+    while ( std::getline( input, token, ',' ) && index < RequestKinds )
+    {
+        // the "name:" prefix is optional, the order is fixed
+        string::size_type colon = token.find( ':' );
+        if ( colon != string::npos )
+        {
+            string name = token.substr( 0, colon );
+            for ( int i = 0; i < RequestKinds; i++ )
+                if ( name == kind_names[i] ) index = i;
+
+            token = token.substr( colon + 1 );
+        }
+
+        opts.mix[ index++ ] = std::max( 0, atoi( token.c_str() ) );
+    }
+}
+
+
+static BenchOptions parse_args( int argc, char ** argv )
+{
+    BenchOptions opts;
+
+    for ( int i = 1; i < argc; i++ )
+    {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if      ( arg == "--gzip" )                     opts.gzip = true;
+        else if ( arg == "--quiet" )                    opts.quiet = true;
+        else if ( arg == "--buttons" && has_value )     opts.buttons     = atoi( argv[++i] );
+        else if ( arg == "--rows" && has_value )        opts.rows        = atoi( argv[++i] );
+        else if ( arg == "--columns" && has_value )     opts.columns     = atoi( argv[++i] );
+        else if ( arg == "--tree" && has_value )        opts.tree        = atoi( argv[++i] );
+        else if ( arg == "--requests" && has_value )    opts.requests    = atoi( argv[++i] );
+        else if ( arg == "--concurrency" && has_value ) opts.concurrency = atoi( argv[++i] );
+        else if ( arg == "--port" && has_value )        opts.port        = atoi( argv[++i] );
+        else if ( arg == "--log" && has_value )         opts.log         = argv[++i];
+        else if ( arg == "--mix" && has_value )         parse_mix( argv[++i], opts );
+        else usage( argv[0] );
+    }
+
+    // the button and the first column are always needed by the requests
+    opts.buttons     = std::max( opts.buttons, 1 );
+    opts.columns     = std::max( opts.columns, 1 );
+    opts.concurrency = std::max( opts.concurrency, 1 );
+
+    if ( opts.mix[0] + opts.mix[1] + opts.mix[2] == 0 )
+        usage( argv[0] );
+
+    return opts;
+}
+
+
+//
+// The tested dialog
+//
+
+static void create_dialog( const BenchOptions & opts )
+{
+    YDialog * dialog = new BenchDialog();
+    YWidget * vbox   = new BenchVBox( dialog );
+
+    for ( int i = 0; i < opts.buttons; i++ )
+    {
+        YWidget * button = new BenchPushButton( vbox, "Button " + std::to_string( i ) );
+        button->setId( new YStringWidgetID( "button_" + std::to_string( i ) ) );
+    }
+
+    YTableHeader * header = new YTableHeader();
+    for ( int c = 0; c < opts.columns; c++ )
+        header->addColumn( "Column " + std::to_string( c ) );
+
+    YTable * table = new BenchTable( vbox, header );
+    table->setId( new YStringWidgetID( "table" ) );
+
+    YItemCollection rows;
+    for ( int r = 0; r < opts.rows; r++ )
+    {
+        YTableItem * item = new YTableItem();
+        item->addCell( "row_" + std::to_string( r ) );
+
+        for ( int c = 1; c < opts.columns; c++ )
+            item->addCell( "cell " + std::to_string( r ) + "/" + std::to_string( c ) );
+
+        rows.push_back( item );
+    }
+    table->addItems( rows );
+
+    YTree * tree = new BenchTree( vbox, "Tree" );
+    tree->setId( new YStringWidgetID( "tree" ) );
+
+    YItemCollection nodes;
+    for ( int t = 0; t < opts.tree; t++ )
+    {
+        string label = "node_" + std::to_string( t );
+        YTreeItem * node = new YTreeItem( label, true );
+        new YTreeItem( node, label + "_a" );
+        new YTreeItem( node, label + "_b" );
+        nodes.push_back( node );
+    }
+    tree->addItems( nodes );
+
+    dialog->open();
+}
+
+
+//
+// The HTTP client
+//
+
+class BenchClient
+{
+public:
+    BenchClient( const BenchOptions & opts, int seed )
+        : _opts( opts ), _fd( -1 ), _random( seed ) {}
+
+    ~BenchClient() { disconnect(); }
+
+    void run( int count, vector<Sample> & samples )
+    {
+        samples.reserve( count );
+
+        for ( int i = 0; i < count; i++ )
+        {
+            RequestKind kind;
+            string request = next_request( kind );
+
+            Clock::time_point start = Clock::now();
+            size_t bytes = 0;
+            bool ok = send_request( request, bytes );
+            std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+            samples.push_back( { kind, elapsed.count(), bytes, ok } );
+        }
+    }
+
+private:
+
+    // generate the next request from the scripted mix
+    string next_request( RequestKind & kind )
+    {
+        int total = _opts.mix[0] + _opts.mix[1] + _opts.mix[2];
+        int pick  = std::uniform_int_distribution<int>( 0, total - 1 )( _random );
+
+        kind = pick < _opts.mix[0] ? WidgetsRequest :
+            pick < _opts.mix[0] + _opts.mix[1] ? DialogRequest : ActionRequest;
+
+        string method = kind == ActionRequest ? "POST" : "GET";
+        string path;
+
+        if ( kind == DialogRequest )
+            path = "/v1/dialog";
+        else
+        {
+            // pick the target widget, the action depends on its type
+            int target = random( 3 );
+
+            if ( target == 0 && _opts.rows > 0 )
+            {
+                path = "/v1/widgets?id=table";
+                if ( kind == ActionRequest )
+                    path += "&action=select&column=0&value=row_" + std::to_string( random( _opts.rows ) );
+            }
+            else if ( target == 1 && _opts.tree > 0 )
+            {
+                path = "/v1/widgets?id=tree";
+                if ( kind == ActionRequest )
+                {
+                    // the tree path "node_N|node_N_a", "|" is URL encoded
+                    string node = "node_" + std::to_string( random( _opts.tree ) );
+                    path += "&action=select&value=" + node + "%7C" + node + "_a";
+                }
+            }
+            else
+            {
+                path = "/v1/widgets?id=button_" + std::to_string( random( _opts.buttons ) );
+                if ( kind == ActionRequest )
+                    path += "&action=press";
+            }
+        }
+
+        string request = method + " " + path + " HTTP/1.1\r\nHost: localhost\r\n";
+
+        if ( _opts.gzip )
+            request += "Accept-Encoding: gzip\r\n";
+
+        if ( method == "POST" )
+            request += "Content-Length: 0\r\n";
+
+        return request + "\r\n";
+    }
+
+    int random( int max )
+    {
+        return std::uniform_int_distribution<int>( 0, std::max( max, 1 ) - 1 )( _random );
+    }
+
+    bool connect_server()
+    {
+        _fd = socket( AF_INET, SOCK_STREAM, 0 );
+        if ( _fd < 0 )
+            return false;
+
+        int flag = 1;
+        setsockopt( _fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof( flag ) );
+
+        struct sockaddr_in addr;
+        memset( &addr, 0, sizeof( addr ) );
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons( _opts.port );
+        addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+        if ( connect( _fd, (struct sockaddr *) &addr, sizeof( addr ) ) < 0 )
+        {
+            disconnect();
+            return false;
+        }
+
+        return true;
+    }
+
+    void disconnect()
+    {
+        if ( _fd >= 0 )
+            close( _fd );
+
+        _fd = -1;
+    }
+
+    // send the request and read the complete response, uses a persistent
+    // connection, reconnects when the server closes it
+    bool send_request( const string & request, size_t & bytes )
+    {
+        if ( _fd < 0 && !connect_server() )
+            return false;
+
+        if ( write( _fd, request.data(), request.size() ) != (ssize_t) request.size() )
+        {
+            // the server might have closed the idle connection, retry once
+            disconnect();
+            if ( !connect_server() || write( _fd, request.data(), request.size() ) != (ssize_t) request.size() )
+                return false;
+        }
+
+        string response;
+        string::size_type header_end;
+        char buffer[ 16384 ];
+
+        while ( ( header_end = response.find( "\r\n\r\n" ) ) == string::npos )
+        {
+            ssize_t len = read( _fd, buffer, sizeof( buffer ) );
+            if ( len <= 0 )
+            {
+                disconnect();
+                return false;
+            }
+            response.append( buffer, len );
+        }
+
+        string headers = response.substr( 0, header_end );
+        std::transform( headers.begin(), headers.end(), headers.begin(), ::tolower );
+
+        size_t content_length = 0;
+        string::size_type pos = headers.find( "\r\ncontent-length:" );
+        if ( pos != string::npos )
+            content_length = strtoul( headers.c_str() + pos + strlen( "\r\ncontent-length:" ), nullptr, 10 );
+
+        size_t received = response.size() - header_end - 4;
+        while ( received < content_length )
+        {
+            ssize_t len = read( _fd, buffer, std::min( sizeof( buffer ), content_length - received ) );
+            if ( len <= 0 )
+            {
+                disconnect();
+                return false;
+            }
+            received += len;
+        }
+
+        bytes = content_length;
+
+        if ( headers.find( "\r\nconnection: close" ) != string::npos )
+            disconnect();
+
+        // "HTTP/1.1 200 OK"
+        int status = atoi( headers.c_str() + strlen( "http/1.1 " ) );
+        return status >= 200 && status < 300;
+    }
+
+    const BenchOptions & _opts;
+    int _fd;
+    std::mt19937 _random;
+};
+
+
+//
+// Results
+//
+
+static double percentile( const vector<double> & sorted, double p )
+{
+    if ( sorted.empty() )
+        return 0.0;
+
+    size_t index = (size_t) ( p * ( sorted.size() - 1 ) + 0.5 );
+    return sorted[ std::min( index, sorted.size() - 1 ) ];
+}
+
+
+static void report_line( const string & name, const vector<Sample> & samples, double seconds )
+{
+    vector<double> latencies;
+    size_t bytes = 0;
+    int errors = 0;
+
+    for ( const Sample & sample : samples )
+    {
+        latencies.push_back( sample.latency_ms );
+        bytes += sample.bytes;
+        if ( !sample.ok ) errors++;
+    }
+
+    std::sort( latencies.begin(), latencies.end() );
+
+    std::cout << std::left  << std::setw( 10 ) << name
+              << std::right << std::setw( 9 )  << samples.size()
+              << std::setw( 8 )  << errors
+              << std::fixed << std::setprecision( 3 )
+              << std::setw( 10 ) << percentile( latencies, 0.50 )
+              << std::setw( 10 ) << percentile( latencies, 0.99 )
+              << std::setw( 10 ) << ( latencies.empty() ? 0.0 : latencies.back() )
+              << std::setprecision( 1 )
+              << std::setw( 11 ) << samples.size() / seconds
+              << std::setw( 14 ) << bytes
+              << std::setw( 11 ) << ( samples.empty() ? 0 : bytes / samples.size() )
+              << std::endl;
+}
+
+
+static void report( const BenchOptions & opts, const vector<Sample> & samples, double seconds )
+{
+    std::cout << "Dialog: " << opts.buttons << " buttons, table " << opts.rows << "x" << opts.columns
+              << ", tree " << opts.tree << " (+" << 2 * opts.tree << " children)" << std::endl
+              << "Requests: " << samples.size() << ", concurrency: " << opts.concurrency
+              << ", mix: widgets:" << opts.mix[0] << ",dialog:" << opts.mix[1] << ",action:" << opts.mix[2]
+              << ( opts.gzip ? ", gzip" : "" ) << std::endl
+              << "Elapsed: " << std::fixed << std::setprecision( 3 ) << seconds << "s" << std::endl
+              << std::endl;
+
+    std::cout << std::left  << std::setw( 10 ) << "request"
+              << std::right << std::setw( 9 )  << "count"
+              << std::setw( 8 )  << "errors"
+              << std::setw( 10 ) << "p50 ms"
+              << std::setw( 10 ) << "p99 ms"
+              << std::setw( 10 ) << "max ms"
+              << std::setw( 11 ) << "req/s"
+              << std::setw( 14 ) << "bytes"
+              << std::setw( 11 ) << "bytes/req"
+              << std::endl;
+
+    for ( int kind = 0; kind < RequestKinds; kind++ )
+    {
+        vector<Sample> selected;
+        std::copy_if( samples.begin(), samples.end(), std::back_inserter( selected ),
+                      [kind]( const Sample & s ) { return s.kind == kind; } );
+
+        if ( !selected.empty() )
+            report_line( kind_names[kind], selected, seconds );
+    }
+
+    report_line( "total", samples, seconds );
+}
+
+
+//
+// Drive the server like the UI main loop does
+//
+
+static void process_requests( YHttpServer & server, const std::atomic<int> & running )
+{
+    vector<struct pollfd> fds;
+
+    while ( running > 0 )
+    {
+        if ( fds.empty() || server.sockets_changed() )
+        {
+            YHttpServerSockets sockets = server.sockets();
+            fds.clear();
+
+            for ( int fd : sockets.read() )      fds.push_back( { fd, POLLIN, 0 } );
+            for ( int fd : sockets.write() )     fds.push_back( { fd, POLLOUT, 0 } );
+            for ( int fd : sockets.exception() ) fds.push_back( { fd, POLLPRI, 0 } );
+        }
+
+        // the server may need to run even without any FD getting ready
+        int server_timeout = server.timeout();
+        bool server_due = server_timeout >= 0 && server_timeout <= 100;
+
+        if ( poll( fds.data(), fds.size(), server_due ? server_timeout : 100 ) > 0 || server_due )
+            server.process_data();
+    }
+}
+
+
+int main( int argc, char ** argv )
+{
+    BenchOptions opts = parse_args( argc, argv );
+
+    YUILog::setLogFileName( opts.log );
+
+    setenv( YUITest_HTTP_PORT, std::to_string( opts.port ).c_str(), 1 );
+    unsetenv( YUITest_HTTP_REMOTE );
+    unsetenv( YUI_HTTP_SOCKET );
+    unsetenv( YUI_AUTH_USER );
+    unsetenv( YUI_AUTH_PASSWD );
+
+    if ( opts.quiet )
+        setenv( YUI_HTTP_QUIET, "1", 1 );
+    else
+        unsetenv( YUI_HTTP_QUIET );
+
+    new BenchUI();
+    create_dialog( opts );
+
+    YHttpServer server;
+    server.start();
+
+    vector< vector<Sample> > results( opts.concurrency );
+    vector<std::thread> clients;
+    std::atomic<int> running( opts.concurrency );
+
+    Clock::time_point start = Clock::now();
+
+    for ( int i = 0; i < opts.concurrency; i++ )
+    {
+        // distribute the remaining requests to the first clients
+        int count = opts.requests / opts.concurrency + ( i < opts.requests % opts.concurrency ? 1 : 0 );
+
+        clients.emplace_back( [&opts, &results, &running, i, count]() {
+            BenchClient client( opts, i + 1 );
+            client.run( count, results[i] );
+            running--;
+        } );
+    }
+
+    process_requests( server, running );
+
+    for ( std::thread & client : clients )
+        client.join();
+
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    vector<Sample> samples;
+    for ( const vector<Sample> & result : results )
+        samples.insert( samples.end(), result.begin(), result.end() );
+
+    report( opts, samples, elapsed.count() );
+
+    YDialog::deleteAllDialogs();
+
+    return 0;
+}
@@ -31,6 +31,7 @@ BuildRequires:  gcc-c++
 BuildRequires:  jsoncpp-devel
 BuildRequires:  libmicrohttpd-devel
 BuildRequires:  boost-devel
+BuildRequires:  zlib-devel
 BuildRequires:  %{libyui_devel_version}
 
 Summary:        Libyui - REST API plugin, the shared part
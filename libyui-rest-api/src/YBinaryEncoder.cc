@@ -0,0 +1,296 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#include <json/json.h>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "YBinaryEncoder.h"
+
+namespace {
+
+    // append the value in the big endian byte order (network order),
+    // used by both CBOR and MessagePack
+    void append_be(std::string &out, uint64_t value, int bytes)
+    {
+        for (int i = bytes - 1; i >= 0; --i)
+            out.push_back((char) ((value >> (8 * i)) & 0xff));
+    }
+
+    void append_double(std::string &out, double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        append_be(out, bits, 8);
+    }
+
+    //
+    // CBOR
+    //
+
+    // write the initial byte with the major type and the argument
+    void cbor_head(std::string &out, uint8_t major, uint64_t value)
+    {
+        major <<= 5;
+
+        if (value < 24)
+            out.push_back((char) (major | value));
+        else if (value <= 0xff)
+        {
+            out.push_back((char) (major | 24));
+            append_be(out, value, 1);
+        }
+        else if (value <= 0xffff)
+        {
+            out.push_back((char) (major | 25));
+            append_be(out, value, 2);
+        }
+        else if (value <= 0xffffffff)
+        {
+            out.push_back((char) (major | 26));
+            append_be(out, value, 4);
+        }
+        else
+        {
+            out.push_back((char) (major | 27));
+            append_be(out, value, 8);
+        }
+    }
+
+    void cbor_string(std::string &out, const char *begin, const char *end)
+    {
+        cbor_head(out, 3, end - begin);
+        out.append(begin, end);
+    }
+
+    void cbor_value(std::string &out, const Json::Value &json)
+    {
+        switch (json.type())
+        {
+            case Json::nullValue:
+                out.push_back((char) 0xf6);
+                break;
+
+            case Json::booleanValue:
+                out.push_back((char) (json.asBool() ? 0xf5 : 0xf4));
+                break;
+
+            case Json::intValue:
+            {
+                Json::Int64 value = json.asInt64();
+                if (value >= 0)
+                    cbor_head(out, 0, value);
+                else
+                    // negative integers are encoded as -1 - N
+                    cbor_head(out, 1, (uint64_t) (-1 - value));
+                break;
+            }
+
+            case Json::uintValue:
+                cbor_head(out, 0, json.asUInt64());
+                break;
+
+            case Json::realValue:
+                out.push_back((char) 0xfb);
+                append_double(out, json.asDouble());
+                break;
+
+            case Json::stringValue:
+            {
+                // the string might contain null characters, do not use asCString()
+                const char *begin = "", *end = begin;
+                json.getString(&begin, &end);
+                cbor_string(out, begin, end);
+                break;
+            }
+
+            case Json::arrayValue:
+                cbor_head(out, 4, json.size());
+                for (const Json::Value &item: json)
+                    cbor_value(out, item);
+                break;
+
+            case Json::objectValue:
+                cbor_head(out, 5, json.size());
+                for (auto it = json.begin(); it != json.end(); ++it)
+                {
+                    const char *end;
+                    const char *begin = it.memberName(&end);
+                    cbor_string(out, begin, end);
+                    cbor_value(out, *it);
+                }
+                break;
+        }
+    }
+
+    //
+    // MessagePack
+    //
+
+    // write a type with a variable size length (string, array, map),
+    // "fixed" is the type for short values with the length in the type byte
+    // and "fixed_max" its maximum length, "typed" are the 8, 16 and 32 bit
+    // length variants (0 if the 8 bit variant does not exist)
+    void msgpack_length(std::string &out, size_t length, uint8_t fixed, size_t fixed_max,
+        uint8_t type8, uint8_t type16, uint8_t type32)
+    {
+        if (length <= fixed_max)
+            out.push_back((char) (fixed | length));
+        else if (type8 && length <= 0xff)
+        {
+            out.push_back((char) type8);
+            append_be(out, length, 1);
+        }
+        else if (length <= 0xffff)
+        {
+            out.push_back((char) type16);
+            append_be(out, length, 2);
+        }
+        else
+        {
+            out.push_back((char) type32);
+            append_be(out, length, 4);
+        }
+    }
+
+    void msgpack_string(std::string &out, const char *begin, const char *end)
+    {
+        msgpack_length(out, end - begin, 0xa0, 31, 0xd9, 0xda, 0xdb);
+        out.append(begin, end);
+    }
+
+    void msgpack_uint(std::string &out, uint64_t value)
+    {
+        if (value <= 0x7f)
+            out.push_back((char) value);
+        else if (value <= 0xff)
+        {
+            out.push_back((char) 0xcc);
+            append_be(out, value, 1);
+        }
+        else if (value <= 0xffff)
+        {
+            out.push_back((char) 0xcd);
+            append_be(out, value, 2);
+        }
+        else if (value <= 0xffffffff)
+        {
+            out.push_back((char) 0xce);
+            append_be(out, value, 4);
+        }
+        else
+        {
+            out.push_back((char) 0xcf);
+            append_be(out, value, 8);
+        }
+    }
+
+    void msgpack_int(std::string &out, int64_t value)
+    {
+        if (value >= 0)
+            msgpack_uint(out, value);
+        else if (value >= -32)
+            out.push_back((char) value);
+        else if (value >= INT8_MIN)
+        {
+            out.push_back((char) 0xd0);
+            append_be(out, (uint64_t) value, 1);
+        }
+        else if (value >= INT16_MIN)
+        {
+            out.push_back((char) 0xd1);
+            append_be(out, (uint64_t) value, 2);
+        }
+        else if (value >= INT32_MIN)
+        {
+            out.push_back((char) 0xd2);
+            append_be(out, (uint64_t) value, 4);
+        }
+        else
+        {
+            out.push_back((char) 0xd3);
+            append_be(out, (uint64_t) value, 8);
+        }
+    }
+
+    void msgpack_value(std::string &out, const Json::Value &json)
+    {
+        switch (json.type())
+        {
+            case Json::nullValue:
+                out.push_back((char) 0xc0);
+                break;
+
+            case Json::booleanValue:
+                out.push_back((char) (json.asBool() ? 0xc3 : 0xc2));
+                break;
+
+            case Json::intValue:
+                msgpack_int(out, json.asInt64());
+                break;
+
+            case Json::uintValue:
+                msgpack_uint(out, json.asUInt64());
+                break;
+
+            case Json::realValue:
+                out.push_back((char) 0xcb);
+                append_double(out, json.asDouble());
+                break;
+
+            case Json::stringValue:
+            {
+                // the string might contain null characters, do not use asCString()
+                const char *begin = "", *end = begin;
+                json.getString(&begin, &end);
+                msgpack_string(out, begin, end);
+                break;
+            }
+
+            case Json::arrayValue:
+                msgpack_length(out, json.size(), 0x90, 15, 0, 0xdc, 0xdd);
+                for (const Json::Value &item: json)
+                    msgpack_value(out, item);
+                break;
+
+            case Json::objectValue:
+                msgpack_length(out, json.size(), 0x80, 15, 0, 0xde, 0xdf);
+                for (auto it = json.begin(); it != json.end(); ++it)
+                {
+                    const char *end;
+                    const char *begin = it.memberName(&end);
+                    msgpack_string(out, begin, end);
+                    msgpack_value(out, *it);
+                }
+                break;
+        }
+    }
+}
+
+void YBinaryEncoder::cbor(const Json::Value &json, std::ostream &output)
+{
+    std::string out;
+    cbor_value(out, json);
+    output.write(out.data(), out.size());
+}
+
+void YBinaryEncoder::msgpack(const Json::Value &json, std::ostream &output)
+{
+    std::string out;
+    msgpack_value(out, json);
+    output.write(out.data(), out.size());
+}
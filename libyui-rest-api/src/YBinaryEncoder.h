@@ -0,0 +1,41 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#ifndef YBinaryEncoder_h
+#define YBinaryEncoder_h
+
+#include <iostream>
+
+namespace Json {
+    class Value;
+}
+
+// encode the JSON value into a compact binary format, the result contains
+// exactly the same data as the JSON text, just without the text formatting
+// and parsing overhead
+class YBinaryEncoder
+{
+
+public:
+
+    // CBOR, see https://tools.ietf.org/html/rfc8949
+    static void cbor(const Json::Value &json, std::ostream &output);
+
+    // MessagePack, see https://github.com/msgpack/msgpack/blob/master/spec.md
+    static void msgpack(const Json::Value &json, std::ostream &output);
+};
+
+#endif // YBinaryEncoder_h
@@ -27,12 +27,11 @@ void YHttpDialogHandler::process_request(struct MHD_Connection* connection,
     std::string& content_type, bool *redraw)
 {
     if (auto dialog = YDialog::topmostDialog(false))  {
-        YJsonSerializer::serialize(dialog, body);
+        YJsonSerializer::serialize(dialog, body, true, items_filter(connection));
         error_code = MHD_HTTP_OK;
     }
     else {
-        body << "{ \"error\" : \"No dialog is open\" }" << std::endl;
-        error_code = MHD_HTTP_NOT_FOUND;
+        error_code = handle_error(body, "No dialog is open", MHD_HTTP_NOT_FOUND);
     }
 
     content_type = "application/json";
@@ -16,45 +16,277 @@
 
 #include <json/json.h>
 #include <microhttpd.h>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
+#include <vector>
+#include <boost/algorithm/string.hpp>
+#include <zlib.h>
 
 #define YUILogComponent "rest-api"
 #include <yui/YUILog.h>
 
 #include "YJsonSerializer.h"
+#include "YHttpServer.h"
 #include "YHttpHandler.h"
 
+// do not compress small responses, it would not save much
+static const size_t compression_threshold = 1024;
+
+// response compression allowed? (enabled by default, the client still needs
+// to ask for it via the Accept-Encoding header)
+static bool compression_enabled()
+{
+    static bool enabled = !(getenv( YUI_HTTP_COMPRESSION ) && strcmp(getenv( YUI_HTTP_COMPRESSION ), "0") == 0);
+    return enabled;
+}
+
+// find the preferred supported encoding from the Accept-Encoding header,
+// returns "gzip", "deflate" or an empty string if compression is not accepted
+static std::string accepted_encoding(struct MHD_Connection *connection)
+{
+    const char *accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+    if (!accept)
+        return "";
+
+    bool gzip = false;
+    bool deflate = false;
+
+    // e.g. "gzip;q=1.0, deflate, identity;q=0.5"
+    std::vector<std::string> codings;
+    boost::split( codings, accept, boost::is_any_of( "," ) );
+
+    for (std::string &coding: codings)
+    {
+        std::vector<std::string> params;
+        boost::split( params, coding, boost::is_any_of( ";" ) );
+        std::string name = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[0] ) );
+
+        // "q=0" means not acceptable
+        bool acceptable = true;
+        for (size_t i = 1; i < params.size(); ++i)
+        {
+            std::string param = boost::algorithm::trim_copy( params[i] );
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+                acceptable = atof(param.c_str() + 2) > 0;
+        }
+
+        if (name == "gzip" || name == "x-gzip")
+            gzip = acceptable;
+        else if (name == "deflate")
+            deflate = acceptable;
+    }
+
+    return gzip ? "gzip" : (deflate ? "deflate" : "");
+}
+
+// find the preferred response format from the Accept header, the JSON text
+// is used unless the client prefers CBOR or MessagePack, "media_type" is set
+// to the accepted media type name of the selected binary format
+static YSerializerFormat accepted_format(struct MHD_Connection *connection, std::string &media_type)
+{
+    const char *accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT);
+    if (!accept)
+        return YSerializerFormat::json;
+
+    // the wildcards are ignored, JSON is the default anyway
+    YSerializerFormat ret = YSerializerFormat::json;
+    double best_quality = 0.0;
+
+    // e.g. "application/cbor, application/json;q=0.5"
+    std::vector<std::string> types;
+    boost::split( types, accept, boost::is_any_of( "," ) );
+
+    for (std::string &type: types)
+    {
+        std::vector<std::string> params;
+        boost::split( params, type, boost::is_any_of( ";" ) );
+        std::string name = boost::algorithm::to_lower_copy( boost::algorithm::trim_copy( params[0] ) );
+
+        double quality = 1.0;
+        for (size_t i = 1; i < params.size(); ++i)
+        {
+            std::string param = boost::algorithm::trim_copy( params[i] );
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=')
+                quality = atof(param.c_str() + 2);
+        }
+
+        YSerializerFormat format;
+        if (name == "application/cbor")
+            format = YSerializerFormat::cbor;
+        else if (name == "application/msgpack" || name == "application/x-msgpack")
+            format = YSerializerFormat::msgpack;
+        else if (name == "application/json")
+            format = YSerializerFormat::json;
+        else
+            continue;
+
+        // the first one wins if the quality is the same
+        if (quality > best_quality)
+        {
+            best_quality = quality;
+            ret = format;
+            media_type = name;
+        }
+    }
+
+    return ret;
+}
+
+// compress the data using the gzip or zlib ("deflate" in HTTP) format
+static bool compress(const std::string &input, std::string &output, bool gzip)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    // prefer speed, the JSON data compress well even at the lowest level,
+    // adding 16 to the window bits selects the gzip format
+    if (deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, gzip ? 15 + 16 : 15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+        return false;
+
+    output.resize(deflateBound(&stream, input.size()));
+
+    stream.next_in = (Bytef *) input.data();
+    stream.avail_in = input.size();
+    stream.next_out = (Bytef *) &output[0];
+    stream.avail_out = output.size();
+
+    int ret = deflate(&stream, Z_FINISH);
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+
+    return ret == Z_STREAM_END;
+}
+
 
 MHD_RESULT YHttpHandler::handle(struct MHD_Connection* connection,
         const char* url, const char* method, const char* upload_data,
-        size_t* upload_data_size, bool *redraw)
+        size_t* upload_data_size, bool *redraw, YHttpRequestStats *stats)
 {
     std::ostringstream body_s;
     std::string content_type;
     int error_code;
 
+    std::string media_type;
+    YSerializerFormat format = accepted_format(connection, media_type);
+    YJsonSerializer::set_format(body_s, format);
+
+    auto start = std::chrono::steady_clock::now();
+
     process_request(connection, url, method, upload_data, upload_data_size,
       body_s, error_code, content_type, redraw);
 
+    if (stats)
+    {
+        stats->process = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->serialization = YJsonSerializer::serialization_time(body_s);
+    }
+
+    // the JSON data have been saved in the requested binary format
+    if (format != YSerializerFormat::json && content_type == "application/json")
+        content_type = media_type;
+
     std::string body_str = body_s.str();
+    size_t body_size = body_str.length();
+
+    std::string encoding;
+    if (compression_enabled() && body_str.length() >= compression_threshold)
+    {
+        encoding = accepted_encoding(connection);
+        std::string compressed;
+
+        if (!encoding.empty() && compress(body_str, compressed, encoding == "gzip"))
+            body_str.swap(compressed);
+        else
+            encoding.clear();
+    }
+
     struct MHD_Response *response = MHD_create_response_from_buffer (body_str.length(),
 		      (void *) body_str.c_str(), MHD_RESPMEM_MUST_COPY);
 
     if (!content_type.empty())
         MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, content_type.c_str());
 
-    yuiMilestone() << "Sending response: code: " << error_code << ", body size: " << body_str.length()
-      << ", content type: " << content_type << std::endl;
+    // the response depends on the Accept and Accept-Encoding headers,
+    // important for caching proxies
+    MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, compression_enabled() ?
+        MHD_HTTP_HEADER_ACCEPT ", " MHD_HTTP_HEADER_ACCEPT_ENCODING : MHD_HTTP_HEADER_ACCEPT);
+
+    if (!encoding.empty())
+        MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_ENCODING, encoding.c_str());
+
+    // tell the client how long an idle persistent connection is kept open
+    if (unsigned int timeout = YHttpServer::connection_timeout())
+        MHD_add_response_header(response, "Keep-Alive", ("timeout=" + std::to_string(timeout)).c_str());
+
+    if (stats)
+    {
+        stats->status = error_code;
+        stats->response_size = body_str.length();
+    }
+
+    if (!YHttpServer::quiet())
+        yuiMilestone() << "Sending response: code: " << error_code << ", body size: " << body_size
+          << ", sent size: " << body_str.length() << ", content type: " << content_type << std::endl;
 
     MHD_RESULT ret = MHD_queue_response(connection, error_code, response);
     MHD_destroy_response (response);
     return ret;
 }
 
+// the target of the handle_error() messages, see collect_errors()
+static std::string *error_target = nullptr;
+
+void YHttpHandler::collect_errors(std::string *error)
+{
+    error_target = error;
+}
+
 int YHttpHandler::handle_error(std::ostream& body, std::string error, int error_code)
 {
+    if (error_target)
+    {
+        *error_target = error;
+        return error_code;
+    }
+
     Json::Value response;
     response["error"] = error;
     YJsonSerializer::save(response, body);
     return error_code;
 }
+
+YJsonItemsFilter YHttpHandler::items_filter(struct MHD_Connection* connection)
+{
+    YJsonItemsFilter filter;
+
+    if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "offset") )
+        filter.offset = atoi(val);
+
+    if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "limit") )
+        filter.limit = atoi(val);
+
+    if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "selected_only") )
+        filter.selected_only = strcmp(val, "1") == 0 || strcmp(val, "true") == 0;
+
+    if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "depth") )
+        filter.depth = atoi(val);
+
+    // comma separated list of the column numbers
+    if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "columns") )
+    {
+        std::vector<std::string> columns;
+        boost::split( columns, val, boost::is_any_of( "," ) );
+
+        for (const std::string &column: columns)
+        {
+            if (!column.empty())
+                filter.columns.push_back(atoi(column.c_str()));
+        }
+    }
+
+    return filter;
+}
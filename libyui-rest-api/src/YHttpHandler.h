@@ -34,6 +34,9 @@
 #include <string>
 #include <iostream>
 
+#include "YHttpMetrics.h"
+#include "YJsonSerializer.h"
+
 struct MHD_Connection;
 
 class YHttpHandler
@@ -44,9 +47,16 @@ public:
     YHttpHandler() {}
     virtual ~YHttpHandler() {}
 
+    /**
+     * Process the request and queue the response.
+     * @param redraw set to true if the UI content has been changed
+     * @param stats if not null the measured processing times and the
+     *     response size are stored there
+     */
     virtual MHD_RESULT handle(struct MHD_Connection* connection,
         const char* url, const char* method, const char* upload_data,
-        size_t* upload_data_size, bool *redraw = nullptr);
+        size_t* upload_data_size, bool *redraw = nullptr,
+        YHttpRequestStats *stats = nullptr);
 
 
 protected:
@@ -57,6 +67,20 @@ protected:
         std::string& content_type, bool *redraw) = 0;
 
     int handle_error(std::ostream& body, std::string error, int error_code);
+
+    /**
+     * Store the message of the following handle_error() calls in "error"
+     * instead of writing the JSON error response to the body, nullptr
+     * restores writing the response. Used for the batch actions which
+     * report the error of each action separately.
+     */
+    static void collect_errors(std::string *error);
+
+    /**
+     * Read the filter for the serialized items from the query parameters
+     * ("offset", "limit", "selected_only", "columns" and "depth").
+     */
+    YJsonItemsFilter items_filter(struct MHD_Connection* connection);
 };
 
 #endif // YHttpHandler_h
@@ -0,0 +1,160 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#include <iomanip>
+#include <set>
+
+#include "YHttpMetrics.h"
+
+// the histogram buckets, the times in seconds, the sizes in bytes
+static const std::vector<double> time_buckets = {
+    0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5
+};
+
+static const std::vector<double> size_buckets = {
+    256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304, 16777216
+};
+
+void YHttpMetrics::Histogram::observe(double value)
+{
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        if (value <= bounds[i])
+        {
+            ++counts[i];
+            break;
+        }
+    }
+
+    ++count;
+    sum += value;
+}
+
+YHttpMetrics::HandlerMetrics::HandlerMetrics()
+    : wait(time_buckets), process(time_buckets), serialization(time_buckets),
+      response_size(size_buckets)
+{
+}
+
+// the method comes from the client, map the unknown ones to a fixed value
+// so they cannot create any number of series
+static std::string method_label(const std::string &method)
+{
+    static const std::set<std::string> known_methods = {
+        "GET", "HEAD", "POST", "PUT", "DELETE", "CONNECT", "OPTIONS", "TRACE", "PATCH"
+    };
+
+    return known_methods.count(method) ? method : "other";
+}
+
+void YHttpMetrics::record(const std::string &method, const std::string &path,
+    const YHttpRequestStats &stats)
+{
+    auto key = std::make_pair(method_label(method), path);
+    auto it = _handlers.find(key);
+
+    if (it == _handlers.end())
+        it = _handlers.insert(std::make_pair(key, HandlerMetrics())).first;
+
+    HandlerMetrics &metrics = it->second;
+
+    ++metrics.responses[stats.status];
+    metrics.wait.observe(stats.wait);
+    metrics.process.observe(stats.process);
+    metrics.serialization.observe(stats.serialization);
+    metrics.response_size.observe(stats.response_size);
+}
+
+// escape a label value for the Prometheus text format
+static std::string escape_label(const std::string &value)
+{
+    std::string ret;
+    ret.reserve(value.size());
+
+    for (char c: value)
+    {
+        switch (c)
+        {
+            case '\\': ret += "\\\\"; break;
+            case '"': ret += "\\\""; break;
+            case '\n': ret += "\\n"; break;
+            default: ret += c;
+        }
+    }
+
+    return ret;
+}
+
+// the labels identifying the handler
+static std::string labels(const std::pair<std::string, std::string> &handler)
+{
+    return "method=\"" + escape_label(handler.first) + "\",handler=\"" +
+        (handler.second.empty() ? "none" : escape_label(handler.second)) + "\"";
+}
+
+void YHttpMetrics::write_histogram(std::ostream &output, const std::string &name,
+    const std::string &help, Histogram HandlerMetrics::*histogram) const
+{
+    output << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << " histogram\n";
+
+    for (const auto &handler: _handlers)
+    {
+        const Histogram &h = handler.second.*histogram;
+        std::string handler_labels = labels(handler.first);
+        uint64_t cumulative = 0;
+
+        for (size_t i = 0; i < h.bounds.size(); ++i)
+        {
+            cumulative += h.counts[i];
+            output << name << "_bucket{" << handler_labels << ",le=\"" << h.bounds[i] << "\"} "
+                << cumulative << '\n';
+        }
+
+        output << name << "_bucket{" << handler_labels << ",le=\"+Inf\"} " << h.count << '\n'
+            << name << "_sum{" << handler_labels << "} " << h.sum << '\n'
+            << name << "_count{" << handler_labels << "} " << h.count << '\n';
+    }
+}
+
+void YHttpMetrics::write(std::ostream &output) const
+{
+    output << std::setprecision(9)
+        << "# HELP yui_http_requests_total Number of processed requests.\n"
+        << "# TYPE yui_http_requests_total counter\n";
+
+    for (const auto &handler: _handlers)
+    {
+        for (const auto &response: handler.second.responses)
+        {
+            output << "yui_http_requests_total{" << labels(handler.first) << ",code=\""
+                << response.first << "\"} " << response.second << '\n';
+        }
+    }
+
+    write_histogram(output, "yui_http_request_wait_seconds",
+        "Time between receiving the request headers and starting the handler.",
+        &HandlerMetrics::wait);
+    write_histogram(output, "yui_http_request_process_seconds",
+        "Time spent in the request handler including the serialization.",
+        &HandlerMetrics::process);
+    write_histogram(output, "yui_http_request_serialization_seconds",
+        "Time spent serializing the response data.",
+        &HandlerMetrics::serialization);
+    write_histogram(output, "yui_http_response_size_bytes",
+        "Size of the sent response body.",
+        &HandlerMetrics::response_size);
+}
@@ -0,0 +1,103 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#ifndef YHttpMetrics_h
+#define YHttpMetrics_h
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * The measured data of a single request.
+ **/
+struct YHttpRequestStats
+{
+    // HTTP response status
+    int status = 0;
+    // seconds between receiving the request headers and starting the handler
+    // (waiting for the request body and for the UI event loop)
+    double wait = 0.0;
+    // seconds spent in the handler, includes the serialization
+    double process = 0.0;
+    // seconds spent serializing the response data
+    double serialization = 0.0;
+    // size of the sent response body in bytes (after compression)
+    size_t response_size = 0;
+};
+
+/**
+ * Aggregated request metrics per handler, the requests are counted by the
+ * response status and the measured times and sizes are collected
+ * in histograms.
+ **/
+class YHttpMetrics
+{
+
+public:
+
+    /**
+     * Record a processed request.
+     * @param method HTTP method
+     * @param path the mount path of the handler, empty if no handler was found
+     * @param stats the measured data
+     **/
+    void record(const std::string &method, const std::string &path,
+        const YHttpRequestStats &stats);
+
+    /**
+     * Write the metrics in the Prometheus text exposition format.
+     **/
+    void write(std::ostream &output) const;
+
+private:
+
+    struct Histogram
+    {
+        Histogram(const std::vector<double> &bounds)
+            : bounds(bounds), counts(bounds.size(), 0) {}
+
+        void observe(double value);
+
+        const std::vector<double> &bounds;
+        // non-cumulative counts, the "+Inf" bucket is the total count
+        std::vector<uint64_t> counts;
+        uint64_t count = 0;
+        double sum = 0.0;
+    };
+
+    struct HandlerMetrics
+    {
+        HandlerMetrics();
+
+        std::map<int, uint64_t> responses;
+        Histogram wait;
+        Histogram process;
+        Histogram serialization;
+        Histogram response_size;
+    };
+
+    void write_histogram(std::ostream &output, const std::string &name, const std::string &help,
+        Histogram HandlerMetrics::*histogram) const;
+
+    // (method, path) => metrics
+    std::map<std::pair<std::string, std::string>, HandlerMetrics> _handlers;
+};
+
+#endif // YHttpMetrics_h
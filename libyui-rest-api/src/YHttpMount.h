@@ -32,6 +32,9 @@ public:
 
     YHttpHandler * handler() {return _handler;}
 
+    const std::string & path() const {return _path;}
+    const std::string & method() const {return _method;}
+
 private:
 
     std::string _path;
@@ -14,15 +14,22 @@
   Floor, Boston, MA 02110-1301 USA
 */
 
+#include <cerrno>
+#include <climits>
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <string>
 #include <sstream>
+#include <vector>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
 #include <arpa/inet.h>
+#include <unistd.h>
 
 #include <microhttpd.h>
 
@@ -33,9 +40,11 @@
 
 #include "YHttpAppHandler.h"
 #include "YHttpDialogHandler.h"
+#include "YHttpMetricsHandler.h"
 #include "YHttpRootHandler.h"
 #include "YHttpVersionHandler.h"
 #include "YHttpWidgetsActionHandler.h"
+#include "YHttpWidgetsBatchHandler.h"
 #include "YHttpWidgetsHandler.h"
 #include "YJsonSerializer.h"
 
@@ -53,6 +62,30 @@ int YHttpServer::port_num()
     return env_port ? atoi(env_port) : 0;
 }
 
+std::string YHttpServer::socket_path()
+{
+    const char* env_socket = getenv( YUI_HTTP_SOCKET );
+    return env_socket ? env_socket : "";
+}
+
+unsigned int YHttpServer::connection_timeout()
+{
+    const char* env_timeout = getenv( YUI_HTTP_CONNECTION_TIMEOUT );
+    return env_timeout ? strtoul(env_timeout, nullptr, 10) : 0;
+}
+
+unsigned int YHttpServer::connection_limit()
+{
+    const char* env_limit = getenv( YUI_HTTP_CONNECTION_LIMIT );
+    return env_limit ? strtoul(env_limit, nullptr, 10) : 0;
+}
+
+bool YHttpServer::quiet()
+{
+    static bool quiet = getenv( YUI_HTTP_QUIET ) && strcmp(getenv( YUI_HTTP_QUIET ), "1") == 0;
+    return quiet;
+}
+
 // For security reasons accept the connections only from the localhost
 // by default, allow listening on all interfaces only when explicitly allowed.
 bool remote_access()
@@ -93,8 +126,22 @@ struct in6_addr listen_address_v6(bool remote)
     return (remote) ? in6addr_any : in6addr_loopback;
 }
 
+// In the epoll mode each daemon exposes only a single epoll FD for all its
+// sockets, the FD does not change when clients connect or disconnect so the
+// UI event loop does not need to update the watched FDs.
+static unsigned int epoll_flag()
+{
+#if MHD_VERSION >= 0x00095400
+    static unsigned int flag = (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES) ? MHD_USE_EPOLL : 0;
+    return flag;
+#else
+    return 0;
+#endif
+}
+
 YHttpServer::YHttpServer(YHttpWidgetsActionHandler * widgets_action_handler)
-    : server_v4(nullptr), server_v6(nullptr), redraw(false)
+    : server_v4(nullptr), server_v6(nullptr), server_unix(nullptr), redraw(false),
+      sockets_reported(false)
 {
     _yserver = this;
     _widget_action_handler = widgets_action_handler;
@@ -133,6 +180,12 @@ YHttpServer::~YHttpServer()
         yuiMilestone() << "Stopping IPv6 HTTP server" << std::endl;
         MHD_stop_daemon(server_v6);
     }
+
+    if (server_unix) {
+        yuiMilestone() << "Stopping Unix socket HTTP server" << std::endl;
+        MHD_stop_daemon(server_unix);
+        unlink(socket_path().c_str());
+    }
 }
 
 // add the server file descriptors to the socket lists
@@ -158,12 +211,48 @@ static void add_fds(struct MHD_Daemon *server, YHttpServerSockets &sockets)
     }
 }
 
+bool YHttpServer::sockets_changed()
+{
+    return !(sockets_reported && epoll_flag());
+}
+
+// the time until the server needs to run again, -1 if not limited
+static int server_timeout(struct MHD_Daemon *server)
+{
+    MHD_UNSIGNED_LONG_LONG timeout;
+
+    if (MHD_YES != MHD_get_timeout(server, &timeout))
+        return -1;
+
+    return timeout > INT_MAX ? INT_MAX : timeout;
+}
+
+int YHttpServer::timeout()
+{
+    int ret = -1;
+
+    for (struct MHD_Daemon *server: {server_v4, server_v6, server_unix})
+    {
+        if (!server)
+            continue;
+
+        int server_wait = server_timeout(server);
+
+        if (server_wait >= 0 && (ret < 0 || server_wait < ret))
+            ret = server_wait;
+    }
+
+    return ret;
+}
+
 YHttpServerSockets YHttpServer::sockets()
 {
     YHttpServerSockets ret;
+    sockets_reported = true;
 
     if (server_v4) add_fds(server_v4, ret);
     if (server_v6) add_fds(server_v6, ret);
+    if (server_unix) add_fds(server_unix, ret);
 
     if (ret.empty())
         yuiWarning() << "Not watching any FD!" << std::endl;
@@ -173,21 +262,35 @@ YHttpServerSockets YHttpServer::sockets()
 
 MHD_RESULT YHttpServer::handle(struct MHD_Connection* connection,
     const char* url, const char* method, const char* upload_data,
-    size_t* upload_data_size)
+    size_t* upload_data_size, double wait)
 {
-    yuiMilestone() << "Processing " << method << " request: "<< url << ", input data size: " << *upload_data_size << std::endl;
+    if (!quiet())
+        yuiMilestone() << "Processing " << method << " request: "<< url << ", input data size: " << *upload_data_size << std::endl;
+
+    YHttpRequestStats stats;
+    stats.wait = wait;
 
     // find the handler
-    for(YHttpMount m: _mounts)
+    for(YHttpMount &m: _mounts)
     {
         if (m.handles(url, method))
-            return m.handler()->handle(connection, url, method, upload_data, upload_data_size, &redraw);
+        {
+            MHD_RESULT ret = m.handler()->handle(connection, url, method, upload_data, upload_data_size, &redraw, &stats);
+            _metrics.record(method, m.path(), stats);
+            return ret;
+        }
     }
 
     // if not found create an empty 404 error response
-    yuiMilestone() << "URL path/method not found, returning error code 404" << std::endl;
+    if (!quiet())
+        yuiMilestone() << "URL path/method not found, returning error code 404" << std::endl;
     struct MHD_Response* response = MHD_create_response_from_buffer(0, 0, MHD_RESPMEM_PERSISTENT);
-    return MHD_queue_response(connection, MHD_HTTP_NOT_FOUND, response);
+    MHD_RESULT ret = MHD_queue_response(connection, MHD_HTTP_NOT_FOUND, response);
+    MHD_destroy_response(response);
+
+    stats.status = MHD_HTTP_NOT_FOUND;
+    _metrics.record(method, "", stats);
+    return ret;
 }
 
 // handle the HTTP Basic Authentication
@@ -205,45 +308,100 @@ bool authenticated(struct MHD_Connection *connection, const YHttpServer *server)
     return success;
 }
 
-// callback for handling the HTTP request
+// the request data collected over the callback calls
+struct RequestData
+{
+    // the uploaded request body
+    std::string upload;
+    // when the request headers have been received
+    std::chrono::steady_clock::time_point received = std::chrono::steady_clock::now();
+};
+
+// process the HTTP request, check the authentication only when required
 static MHD_RESULT
-requestHandler(void *srv,
+processRequest(YHttpServer *server,
           struct MHD_Connection *connection,
           const char *url,
           const char *method,
-          const char *version,
-          const char *upload_data, size_t *upload_data_size, void **ptr)
+          const char *upload_data, size_t *upload_data_size, void **ptr,
+          bool check_auth)
 {
-    // remember the callback status
-    static int aptr;
+    RequestData *request = (RequestData *) *ptr;
 
-    if (&aptr != *ptr)
+    if (!request)
     {
         // do not respond on first call, it's used for the initial check to close invalid requests early
-        *ptr = &aptr;
+        *ptr = new RequestData();
         // continue processing the request
         return MHD_YES;
     }
-    // reset
-    *ptr = NULL;
 
-    YHttpServer *server = (YHttpServer *)srv;
+    // the body might be uploaded in several chunks, respond after receiving all of them
+    if (*upload_data_size != 0)
+    {
+        request->upload.append(upload_data, *upload_data_size);
+        *upload_data_size = 0;
+        return MHD_YES;
+    }
 
     // the basic auth is configured and failed
-    if ((!server->user().empty() || !server->passwd().empty()) && !authenticated(connection, server))
+    if (check_auth && (!server->user().empty() || !server->passwd().empty()) && !authenticated(connection, server))
     {
         struct MHD_Response *response = MHD_create_response_from_buffer(strlen(auth_error_body),
             (void *) auth_error_body, MHD_RESPMEM_PERSISTENT);
         MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, "application/json");
-        return MHD_queue_basic_auth_fail_response(connection, "libyui realm", response);
+        MHD_RESULT ret = MHD_queue_basic_auth_fail_response(connection, "libyui realm", response);
+        MHD_destroy_response(response);
+        return ret;
     }
 
-    return server->handle(connection, url, method, upload_data, upload_data_size);
+    double wait = std::chrono::duration<double>(std::chrono::steady_clock::now() - request->received).count();
+    size_t upload_size = request->upload.size();
+    return server->handle(connection, url, method, request->upload.c_str(), &upload_size, wait);
+}
+
+// callback for handling the HTTP request (TCP connections)
+static MHD_RESULT
+requestHandler(void *srv,
+          struct MHD_Connection *connection,
+          const char *url,
+          const char *method,
+          const char *version,
+          const char *upload_data, size_t *upload_data_size, void **ptr)
+{
+    return processRequest((YHttpServer *) srv, connection, url, method,
+        upload_data, upload_data_size, ptr, true);
+}
+
+// callback for handling the HTTP request (Unix domain socket connections),
+// the access is controlled by the socket file permissions, no authentication
+static MHD_RESULT
+unixRequestHandler(void *srv,
+          struct MHD_Connection *connection,
+          const char *url,
+          const char *method,
+          const char *version,
+          const char *upload_data, size_t *upload_data_size, void **ptr)
+{
+    return processRequest((YHttpServer *) srv, connection, url, method,
+        upload_data, upload_data_size, ptr, false);
+}
+
+// callback called when a request is finished (also when it was aborted),
+// releases the request data collected by requestHandler()
+static void requestCompleted(void *srv, struct MHD_Connection *connection,
+    void **ptr, enum MHD_RequestTerminationCode toe)
+{
+    delete (RequestData *) *ptr;
+    *ptr = NULL;
 }
 
 // callback called when a new client connects to the HTTP server,
 // could be used for access control, we just use it for access logging
 static MHD_RESULT onConnect(void *srv, const struct sockaddr *addr, socklen_t addrlen) {
+    if (YHttpServer::quiet())
+        return MHD_YES;
+
     if (addr->sa_family == AF_INET) {
         struct sockaddr_in *addr_in = (struct sockaddr_in *) addr;
         // macro INET_ADDRSTRLEN contains the maximum length of an IPv4 address
@@ -260,6 +418,10 @@ static MHD_RESULT onConnect(void *srv, const struct sockaddr *addr, socklen_t ad
         yuiMilestone() << "Received an IPv6 connection from " << buffer << std::endl;
     }
 
+    if (addr->sa_family == AF_UNIX) {
+        yuiMilestone() << "Received a Unix socket connection" << std::endl;
+    }
+
     // always continue processing the request
     return MHD_YES;
 }
@@ -270,11 +432,45 @@ void YHttpServer::start()
     mount("/dialog", "GET", new YHttpDialogHandler());
     mount("/widgets", "GET", new YHttpWidgetsHandler());
     mount("/widgets", "POST", get_widget_action_handler());
+    mount("/widgets/batch", "POST", new YHttpWidgetsBatchHandler(get_widget_action_handler()));
     mount("/application", "GET", new YHttpAppHandler());
     mount("/version", "GET", new YHttpVersionHandler(), false);
+    mount("/metrics", "GET", new YHttpMetricsHandler(&_metrics));
 
     bool remote = remote_access();
 
+    // the options common for both IPv4 and IPv6 servers
+    std::vector<MHD_OptionItem> options;
+    // release the request data
+    options.push_back({ MHD_OPTION_NOTIFY_COMPLETED, (intptr_t) &requestCompleted, this });
+    // allow or forbid reusing the socket for multiple processes
+    options.push_back({ MHD_OPTION_LISTENING_ADDRESS_REUSE, port_reuse(), nullptr });
+
+    // the persistent connections are kept open until the client closes them
+    // or until the idle timeout is reached (if set)
+    if (unsigned int timeout = connection_timeout())
+    {
+        yuiMilestone() << "Connection timeout: " << timeout << "s" << std::endl;
+        options.push_back({ MHD_OPTION_CONNECTION_TIMEOUT, timeout, nullptr });
+    }
+
+    if (unsigned int limit = connection_limit())
+    {
+        yuiMilestone() << "Connection limit per listener: " << limit << std::endl;
+        options.push_back({ MHD_OPTION_CONNECTION_LIMIT, limit, nullptr });
+    }
+
+    options.push_back({ MHD_OPTION_END, 0, nullptr });
+
+    if (port_num() > 0)
+        start_tcp(options.data(), remote);
+
+    if (!socket_path().empty())
+        start_unix(options.data());
+}
+
+void YHttpServer::start_tcp(const MHD_OptionItem *options, bool remote)
+{
     // setup the IPv4 server
     sockaddr_in server_socket;
     server_socket.sin_family = AF_INET;
@@ -282,15 +478,15 @@ void YHttpServer::start()
     server_socket.sin_addr.s_addr = listen_address_v4(remote);
     server_v4 = MHD_start_daemon (
                         // enable debugging output (on STDERR)
-                        MHD_USE_DEBUG,
+                        MHD_USE_DEBUG | epoll_flag(),
                         // the port number to use
                         port_num(),
                         // handler for new connections
                         &onConnect, this,
                         // handler for processing requests
                         &requestHandler, this,
-                        // allow or forbid reusing the socket for multiple processes
-                        MHD_OPTION_LISTENING_ADDRESS_REUSE, port_reuse(),
+                        // the common options
+                        MHD_OPTION_ARRAY, options,
                         // set the port and interface to listen to
                         MHD_OPTION_SOCK_ADDR, &server_socket,
                         // finish the argument list
@@ -303,7 +499,7 @@ void YHttpServer::start()
     server_socket_v6.sin6_addr = listen_address_v6(remote);
     server_v6 = MHD_start_daemon (
                         // enable debugging output (on STDERR)
-                        MHD_USE_DEBUG |
+                        MHD_USE_DEBUG | epoll_flag() |
                         // use IPv6
                         MHD_USE_IPv6,
                         // the port number to use
@@ -312,9 +508,8 @@ void YHttpServer::start()
                         &onConnect, this,
                         // handler for processing requests
                         &requestHandler, this,
-                        // disable reusing the socket for multiple processes,
-                        // for security reasons allow only one process to use this port
-                        MHD_OPTION_LISTENING_ADDRESS_REUSE, port_reuse(),
+                        // the common options
+                        MHD_OPTION_ARRAY, options,
                         // set the port and interface to listen to
                         MHD_OPTION_SOCK_ADDR, &server_socket_v6,
                         // finish the argument list
@@ -338,12 +533,93 @@ void YHttpServer::start()
     // FIXME: exit when no server available?
 }
 
+// create a listening Unix domain socket, returns -1 on error
+static int unix_socket(const std::string &path)
+{
+    struct sockaddr_un addr;
+
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        yuiError() << "Socket path too long: " << path << std::endl;
+        return -1;
+    }
+
+    // remove a stale socket left by a previous run, but never remove other files
+    struct stat st;
+    if (lstat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        unlink(path.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        yuiError() << "Cannot create Unix socket: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+    // the file permissions replace the authentication, by default allow
+    // the access only for the owner (the permissions can be changed later)
+    mode_t orig_umask = umask(0177);
+    int ret = bind(fd, (struct sockaddr *) &addr, sizeof(addr));
+    umask(orig_umask);
+
+    if (ret < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        yuiError() << "Cannot listen on Unix socket " << path << ": " << strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void YHttpServer::start_unix(const MHD_OptionItem *options)
+{
+    std::string path = socket_path();
+    int fd = unix_socket(path);
+
+    if (fd >= 0)
+    {
+        server_unix = MHD_start_daemon (
+                        // enable debugging output (on STDERR)
+                        MHD_USE_DEBUG | epoll_flag(),
+                        // the port is not used
+                        0,
+                        // handler for new connections
+                        &onConnect, this,
+                        // handler for processing requests
+                        &unixRequestHandler, this,
+                        // the common options
+                        MHD_OPTION_ARRAY, options,
+                        // use the already created socket
+                        MHD_OPTION_LISTEN_SOCKET, fd,
+                        // finish the argument list
+                        MHD_OPTION_END);
+
+        if (server_unix == nullptr)
+            close(fd);
+    }
+
+    if (server_unix == nullptr) {
+      std::cerr << "Cannot start the HTTP server at Unix socket " << path << std::endl;
+      yuiError() << "Cannot start the HTTP server at Unix socket " << path << std::endl;
+    }
+    else {
+        yuiWarning() << "Started REST API HTTP server at Unix socket " << path << std::endl;
+    }
+}
+
 bool YHttpServer::process_data()
 {
     redraw = false;
-    yuiMilestone() << "Processing HTTP server data..." << std::endl;
+    if (!quiet())
+        yuiMilestone() << "Processing HTTP server data..." << std::endl;
     if (server_v4) MHD_run(server_v4);
     if (server_v6) MHD_run(server_v6);
+    if (server_unix) MHD_run(server_unix);
     return redraw;
 }
 
@@ -22,6 +22,7 @@
 
 #include "YHttpMount.h"
 #include "YHttpHandler.h"
+#include "YHttpMetrics.h"
 #include "YHttpServerSockets.h"
 #include "YHttpWidgetsActionHandler.h"
 
@@ -31,10 +32,16 @@
 #define YUI_AUTH_USER       "YUI_AUTH_USER"
 #define YUI_AUTH_PASSWD     "YUI_AUTH_PASSWD"
 #define YUI_REUSE_PORT      "YUI_REUSE_PORT"
+#define YUI_HTTP_CONNECTION_LIMIT   "YUI_HTTP_CONNECTION_LIMIT"
+#define YUI_HTTP_CONNECTION_TIMEOUT "YUI_HTTP_CONNECTION_TIMEOUT"
+#define YUI_HTTP_COMPRESSION        "YUI_HTTP_COMPRESSION"
+#define YUI_HTTP_SOCKET             "YUI_HTTP_SOCKET"
+#define YUI_HTTP_QUIET              "YUI_HTTP_QUIET"
 
 #define YUI_API_VERSION     "v1"
 
 struct MHD_Daemon;
+struct MHD_OptionItem;
 
 class YHttpServer
 {
@@ -43,7 +50,7 @@ public:
 
     static bool enabled()
     {
-        static bool enabled = port_num() != 0;
+        static bool enabled = port_num() != 0 || !socket_path().empty();
         return enabled;
     }
 
@@ -54,6 +61,29 @@ public:
 
     static int port_num();
 
+    /**
+     * Path of the Unix domain socket to listen on, empty if not set.
+     **/
+    static std::string socket_path();
+
+    /**
+     * Idle timeout for the persistent (keep-alive) connections in seconds,
+     * 0 means no timeout.
+     **/
+    static unsigned int connection_timeout();
+
+    /**
+     * Maximum number of the concurrent connections per listener (IPv4,
+     * IPv6 and Unix socket), 0 means the default limit of the HTTP server
+     * library.
+     **/
+    static unsigned int connection_limit();
+
+    /**
+     * Low overhead mode, do not log each request at the milestone level.
+     **/
+    static bool quiet();
+
     /**
      * Constructor to override widgets action handler. Is used in case there
      * are UI specific actions for the widget.
@@ -82,11 +112,33 @@ public:
      */
     YHttpServerSockets sockets();
 
+    /**
+     * Might the FDs returned by sockets() have changed since the last call?
+     * If the server uses the epoll mode the FDs never change, otherwise
+     * they change when a client connects or disconnects so this always
+     * returns true.
+     */
+    bool sockets_changed();
+
+    /**
+     * Maximum time in milliseconds the UI may wait on the FDs before calling
+     * process_data() again, -1 means no limit. The HTTP server might have
+     * work to do without any FD becoming ready (e.g. in the epoll mode it
+     * continues partial writes and closes timed out connections only when
+     * process_data() is called), so the UI event loop must not wait longer.
+     */
+    int timeout();
+
     void mount(std::string path, const std::string &method, YHttpHandler *handler, bool has_api_version = true);
 
+    /**
+     * Handle the request
+     * @param wait time since receiving the request headers (in seconds),
+     *     recorded in the metrics
+     */
     MHD_RESULT handle(struct MHD_Connection* connection,
         const char* url, const char* method, const char* upload_data,
-        size_t* upload_data_size);
+        size_t* upload_data_size, double wait = 0.0);
 
     // must be public to be accessible from a plain C callback :-/
     std::string user() const {return auth_user;}
@@ -96,8 +148,13 @@ private:
 
     // dual stack support (for both IPv4 and IPv6)
     struct MHD_Daemon *server_v4, *server_v6;
+    // local access via Unix domain socket
+    struct MHD_Daemon *server_unix;
     std::vector<YHttpMount> _mounts;
+    YHttpMetrics _metrics;
     bool redraw;
+    // sockets() has been called already
+    bool sockets_reported;
     static YHttpServer * _yserver;
     static YHttpWidgetsActionHandler * _widget_action_handler;
     // HTTP Basic Auth credentials
@@ -106,6 +163,9 @@ private:
 
     static YHttpWidgetsActionHandler * get_widget_action_handler() { return _widget_action_handler; }
 
+    void start_tcp(const MHD_OptionItem *options, bool remote);
+    void start_unix(const MHD_OptionItem *options);
+
 protected:
 };
 
@@ -15,11 +15,14 @@
 */
 
 #include <codecvt>
+#include <map>
 #include <vector>
 #include <sstream>
 #include <cstdlib>
 #include <string>
 
+#include <json/json.h>
+
 #define YUILogComponent "rest-api"
 #include <yui/YUILog.h>
 
@@ -38,6 +41,7 @@
 #include <yui/YTreeItem.h>
 #include <yui/YWidgetID.h>
 
+#include "YHttpServer.h"
 #include "YHttpWidgetsActionHandler.h"
 
 
@@ -62,15 +66,13 @@ void YHttpWidgetsActionHandler::process_request(struct MHD_Connection* connectio
         }
         else
         {
-            body << "{ \"error\" : \"No search criteria provided\" }" << std::endl;
-            error_code = MHD_HTTP_NOT_FOUND;
+            error_code = handle_error( body, "No search criteria provided", MHD_HTTP_NOT_FOUND );
             return;
         }
 
         if ( widgets.empty() )
         {
-            body << "{ \"error\" : \"Widget not found\" }" << std::endl;
-            error_code = MHD_HTTP_NOT_FOUND;
+            error_code = handle_error( body, "Widget not found", MHD_HTTP_NOT_FOUND );
             return;
         }
 
@@ -78,8 +80,7 @@ void YHttpWidgetsActionHandler::process_request(struct MHD_Connection* connectio
         {
             if( widgets.size() != 1 )
             {
-                body << "{ \"error\" : \"Multiple widgets found to act on, try using multicriteria search (label+id+type)\" }" << std::endl;
-                error_code = MHD_HTTP_NOT_FOUND;
+                error_code = handle_error( body, "Multiple widgets found to act on, try using multicriteria search (label+id+type)", MHD_HTTP_NOT_FOUND );
                 return;
             }
 
@@ -91,17 +92,111 @@ void YHttpWidgetsActionHandler::process_request(struct MHD_Connection* connectio
         }
         else
         {
-            body << "{ \"error\" : \"Missing action parameter\" }" << std::endl;
-            error_code = MHD_HTTP_NOT_FOUND;
+            error_code = handle_error( body, "Missing action parameter", MHD_HTTP_NOT_FOUND );
         }
     }
     else {
-        body << "{ \"error\" : \"No dialog is open\" }" << std::endl;
-        error_code = MHD_HTTP_NOT_FOUND;
+        error_code = handle_error( body, "No dialog is open", MHD_HTTP_NOT_FOUND );
+    }
+}
+
+int YHttpWidgetsActionHandler::do_actions(const Json::Value &actions, Json::Value &results)
+{
+    results = Json::Value(Json::arrayValue);
+
+    for (const Json::Value &action_spec: actions)
+    {
+        Json::Value result;
+        std::string error;
+        int code = do_batch_action(action_spec, error);
+
+        result["status"] = code;
+
+        if (!error.empty())
+            result["error"] = error;
+
+        results.append(result);
+
+        if (code != MHD_HTTP_OK)
+        {
+            if (!YHttpServer::quiet())
+                yuiMilestone() << "Batch action #" << results.size() - 1 << " failed, skipping the rest" << std::endl;
+            return code;
+        }
     }
+
+    return MHD_HTTP_OK;
+}
+
+int YHttpWidgetsActionHandler::do_batch_action(const Json::Value &action_spec, std::string &error)
+{
+    auto fail = [&error] (const char *message, int code) {
+        error = message;
+        return code;
+    };
+
+    if (!action_spec.isObject())
+        return fail( "Action must be a JSON object", MHD_HTTP_BAD_REQUEST );
+
+    // the parameters are converted to strings to be handled
+    // exactly the same way as the query parameters
+    std::map<std::string, std::string> params;
+    for (const std::string &key: action_spec.getMemberNames())
+    {
+        const Json::Value &val = action_spec[key];
+        if (val.isString() || val.isNumeric() || val.isBool())
+            params[key] = val.asString();
+    }
+
+    auto param = [&params] (const char *name) -> const char* {
+        auto it = params.find(name);
+        return it == params.end() ? nullptr : it->second.c_str();
+    };
+
+    // the previous action might have closed the dialog
+    if ( !YDialog::topmostDialog(false) )
+        return fail( "No dialog is open", MHD_HTTP_NOT_FOUND );
+
+    const char* label = param("label");
+    const char* id = param("id");
+    const char* type = param("type");
+
+    if ( !label && !id && !type )
+        return fail( "No search criteria provided", MHD_HTTP_NOT_FOUND );
+
+    WidgetArray widgets = YWidgetFinder::find(label, id, type);
+
+    if ( widgets.empty() )
+        return fail( "Widget not found", MHD_HTTP_NOT_FOUND );
+
+    const char* action = param("action");
+
+    if ( !action )
+        return fail( "Missing action parameter", MHD_HTTP_NOT_FOUND );
+
+    if ( widgets.size() != 1 )
+        return fail( "Multiple widgets found to act on, try using multicriteria search (label+id+type)", MHD_HTTP_NOT_FOUND );
+
+    // the action reports its errors via handle_error(), collect the message
+    // instead of serializing it to the response body which is not used
+    struct ErrorCollector
+    {
+        ErrorCollector(std::string *error) { collect_errors(error); }
+        ~ErrorCollector() { collect_errors(nullptr); }
+    } collector(&error);
+
+    std::ostringstream body;
+    return do_action(widgets[0], action, param, body);
 }
 
 int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &action, struct MHD_Connection *connection, std::ostream& body)
+{
+    return do_action(widget, action, [connection] (const char *name) {
+        return MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, name);
+    }, body);
+}
+
+int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &action, const ParamLookup &param, std::ostream& body)
 {
 
     // TODO improve this, maybe use better names for the actions...
@@ -149,7 +244,7 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
         else
         {
             std::string value;
-            if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "value") )
+            if ( const char* val = param("value") )
                 value = val;
 
             if( YItemSelector* selector = dynamic_cast<YItemSelector*>(widget) )
@@ -195,7 +290,7 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
         else
         {
             std::string value;
-            if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "value") )
+            if ( const char* val = param("value") )
                 value = val;
 
             if( YItemSelector* selector = dynamic_cast<YItemSelector*>(widget) )
@@ -243,7 +338,7 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
         else
         {
             std::string value;
-            if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "value") )
+            if ( const char* val = param("value") )
                 value = val;
 
             if( YItemSelector* selector = dynamic_cast<YItemSelector*>(widget) )
@@ -269,7 +364,7 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
     else if ( action == "enter_text" )
     {
         std::string value;
-        if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "value") )
+        if ( const char* val = param("value") )
             value = val;
 
         if ( dynamic_cast<YInputField*>(widget) )
@@ -339,7 +434,7 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
     else if ( action == "select" )
     {
         std::string value;
-        if (const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "value"))
+        if (const char* val = param("value"))
             value = val;
         if ( dynamic_cast<YComboBox*>(widget) )
         {
@@ -362,11 +457,11 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
         else if( auto tbl = dynamic_cast<YTable*>(widget) )
         {
             int row_id = -1;
-            if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "row") )
+            if ( const char* val = param("row") )
                 row_id = atoi(val);
 
             int column_id = 0;
-            if ( const char* val = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "column") )
+            if ( const char* val = param("column") )
                 column_id = atoi(val);
 
             return action_handler<YTable>( widget, body, get_table_handler()->get_handler( tbl, value, column_id, row_id) );
@@ -473,8 +568,7 @@ int YHttpWidgetsActionHandler::do_action(YWidget *widget, const std::string &act
     }
     else
     {
-        body << "{ \"error\" : \"Unknown action\" }" << std::endl;
-        return MHD_HTTP_NOT_FOUND;
+        return handle_error( body, "Unknown action", MHD_HTTP_NOT_FOUND );
     }
 
     return MHD_HTTP_OK;
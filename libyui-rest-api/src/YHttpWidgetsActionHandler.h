@@ -43,6 +43,9 @@
 
 #include "YHttpHandler.h"
 
+namespace Json {
+    class Value;
+}
 
 class YHttpWidgetsActionHandler : public YHttpHandler
 {
@@ -52,6 +55,28 @@ public:
     YHttpWidgetsActionHandler() {};
     virtual ~YHttpWidgetsActionHandler() {};
 
+    /**
+     * Lookup function for the action parameters ("value", "row", "column"),
+     * returns nullptr if the parameter is not set.
+     **/
+    typedef std::function<const char* (const char*)> ParamLookup;
+
+    /**
+     * Process a batch of actions, each action is a JSON object with the same
+     * keys as the query parameters of a single action request ("id", "label",
+     * "type", "action", "value", "row", "column"). The actions are executed
+     * in the given order, the processing stops at the first failed action.
+     * The application handles the events triggered by the actions (e.g.
+     * pressing a button) only after the whole batch: the following actions
+     * still work with the same dialog and if several actions trigger an
+     * event then only the last one is reported to the application.
+     * @param actions JSON array with the actions
+     * @param results JSON array with the result of each executed action
+     * @return HTTP status code, MHD_HTTP_OK if all actions succeeded,
+     *     otherwise the status code of the failed action
+     */
+    int do_actions( const Json::Value &actions, Json::Value &results );
+
 protected:
 
     virtual void process_request(struct MHD_Connection* connection,
@@ -61,6 +86,15 @@ protected:
 
     int do_action( YWidget *widget, const std::string &action, struct MHD_Connection *connection, std::ostream& body );
 
+    int do_action( YWidget *widget, const std::string &action, const ParamLookup &param, std::ostream& body );
+
+    /**
+     * Find the widget and do the action described by a single batch item.
+     * @param error set to the error message if the action failed
+     * @return HTTP status code
+     */
+    int do_batch_action( const Json::Value &action_spec, std::string &error );
+
     /**
      * Define widgets handlers to override in case need to implement
      * UI specific actions, like activation.
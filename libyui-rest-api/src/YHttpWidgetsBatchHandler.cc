@@ -0,0 +1,79 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#include <memory>
+#include <sstream>
+
+#include <json/json.h>
+#include <microhttpd.h>
+
+#define YUILogComponent "rest-api"
+#include <yui/YUILog.h>
+
+#include <yui/YDialog.h>
+
+#include "YJsonSerializer.h"
+#include "YHttpServer.h"
+#include "YHttpWidgetsBatchHandler.h"
+
+
+void YHttpWidgetsBatchHandler::process_request(struct MHD_Connection* connection,
+    const char* url, const char* method, const char* upload_data,
+    size_t* upload_data_size, std::ostream& body, int& error_code,
+    std::string& content_type, bool *redraw)
+{
+    content_type = "application/json";
+
+    if ( !YDialog::topmostDialog(false) )
+    {
+        error_code = handle_error( body, "No dialog is open", MHD_HTTP_NOT_FOUND );
+        return;
+    }
+
+    Json::Value actions;
+    std::string parse_errors;
+    Json::CharReaderBuilder builder;
+    std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+    size_t size = upload_data_size ? *upload_data_size : 0;
+
+    if ( !upload_data || !reader->parse(upload_data, upload_data + size, &actions, &parse_errors) )
+    {
+        error_code = handle_error( body, "Cannot parse the actions: " + parse_errors, MHD_HTTP_BAD_REQUEST );
+        return;
+    }
+
+    if ( !actions.isArray() || actions.empty() )
+    {
+        error_code = handle_error( body, "Expected a non-empty JSON array of actions", MHD_HTTP_BAD_REQUEST );
+        return;
+    }
+
+    if (!YHttpServer::quiet())
+        yuiMilestone() << "Processing " << actions.size() << " batch actions" << std::endl;
+
+    Json::Value results;
+    error_code = _action_handler->do_actions( actions, results );
+
+    // redraw also after a partial success, the UI might have been changed
+    // by the actions processed before the failed one
+    int succeeded = error_code == MHD_HTTP_OK ? results.size() : results.size() - 1;
+    if ( redraw && succeeded > 0 )
+        *redraw = true;
+
+    Json::Value response;
+    response["results"] = results;
+    YJsonSerializer::save( response, body );
+}
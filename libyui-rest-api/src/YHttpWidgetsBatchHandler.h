@@ -0,0 +1,53 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+#ifndef YHttpWidgetsBatchHandler_h
+#define YHttpWidgetsBatchHandler_h
+
+#include "YHttpHandler.h"
+#include "YHttpWidgetsActionHandler.h"
+
+/**
+ * Handler for doing several widget actions in a single request, the actions
+ * are passed as a JSON array in the request body. All actions are processed
+ * at once so the UI is redrawn only once after the whole batch.
+ **/
+class YHttpWidgetsBatchHandler : public YHttpHandler
+{
+
+public:
+
+    /**
+     * @param action_handler the handler doing the single actions, allows
+     *     using the UI specific actions also in the batch mode
+     **/
+    YHttpWidgetsBatchHandler( YHttpWidgetsActionHandler * action_handler )
+        : _action_handler( action_handler ) {}
+    virtual ~YHttpWidgetsBatchHandler() {}
+
+protected:
+
+    virtual void process_request(struct MHD_Connection* connection,
+        const char* url, const char* method, const char* upload_data,
+        size_t* upload_data_size, std::ostream& body, int& error_code,
+        std::string& content_type, bool *redraw);
+
+private:
+
+    YHttpWidgetsActionHandler * _action_handler;
+};
+
+#endif // YHttpWidgetsBatchHandler_h
@@ -44,18 +44,16 @@ void YHttpWidgetsHandler::process_request(struct MHD_Connection* connection,
         }
 
         if (widgets.empty()) {
-            body << "{ \"error\" : \"Widget not found\" }" << std::endl;
-            error_code = MHD_HTTP_NOT_FOUND;
+            error_code = handle_error(body, "Widget not found", MHD_HTTP_NOT_FOUND);
         }
         else {
             // non recursive dump
-            YJsonSerializer::serialize(widgets, body, false);
+            YJsonSerializer::serialize(widgets, body, false, items_filter(connection));
             error_code = MHD_HTTP_OK;
         }
     }
     else {
-        body << "{ \"error\" : \"No dialog is open\" }" << std::endl;
-        error_code = MHD_HTTP_NOT_FOUND;
+        error_code = handle_error(body, "No dialog is open", MHD_HTTP_NOT_FOUND);
     }
 
     content_type = "application/json";
@@ -15,6 +15,7 @@
 */
 
 #include <json/json.h>
+#include <chrono>
 
 #include <yui/YBarGraph.h>
 #include <yui/YButtonBox.h>
@@ -41,18 +42,19 @@
 #include <yui/YWidgetID.h>
 #include <yui/YWizard.h>
 
+#include "YBinaryEncoder.h"
 #include "YJsonSerializer.h"
 
 static void serialize_widget_properties(YWidget *widget, Json::Value &json);
 static void serialize_widget_data(YWidget *widget, Json::Value &json);
-static void serialize_widget_specific_data(YWidget *widget, Json::Value &json);
+static void serialize_widget_specific_data(YWidget *widget, Json::Value &json, const YJsonItemsFilter &filter);
 
-Json::Value serialize_rec(YWidget *w, bool recursive = true) {
+Json::Value serialize_rec(YWidget *w, bool recursive = true, const YJsonItemsFilter &filter = YJsonItemsFilter()) {
     Json::Value ret;
 
     serialize_widget_properties(w, ret);
     serialize_widget_data(w, ret);
-    serialize_widget_specific_data(w, ret);
+    serialize_widget_specific_data(w, ret, filter);
 
     if (recursive && w->hasChildren()) {
         Json::Value widgets;
@@ -61,7 +63,7 @@ Json::Value serialize_rec(YWidget *w, bool recursive = true) {
         {
             if (*it)
             {
-                Json::Value widget = serialize_rec(*it);
+                Json::Value widget = serialize_rec(*it, true, filter);
                 widgets.append(widget);
             }
         }
@@ -72,31 +74,94 @@ Json::Value serialize_rec(YWidget *w, bool recursive = true) {
     return ret;
 }
 
+// index of the format flag in the internal extensible array of the stream,
+// the new streams have it zero-initialized which means JSON
+static int format_index()
+{
+    static int index = std::ios_base::xalloc();
+    return index;
+}
+
+void YJsonSerializer::set_format(std::ostream &output, YSerializerFormat format)
+{
+    output.iword(format_index()) = static_cast<long>(format);
+}
+
+YSerializerFormat YJsonSerializer::format(std::ostream &output)
+{
+    return static_cast<YSerializerFormat>(output.iword(format_index()));
+}
+
+// index of the accumulated serialization time (in microseconds)
+static int time_index()
+{
+    static int index = std::ios_base::xalloc();
+    return index;
+}
+
+// add the time elapsed since "start" to the serialization time of the stream
+static void add_time(std::ostream &output, std::chrono::steady_clock::time_point start)
+{
+    output.iword(time_index()) += std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+double YJsonSerializer::serialization_time(std::ostream &output)
+{
+    return output.iword(time_index()) / 1e6;
+}
+
 void YJsonSerializer::save(const Json::Value &json, std::ostream &output)
 {
-    // use a custom indentation, the default it too big,
-    // the dialogs usually have too many nested widgets
-    Json::StreamWriterBuilder builder;
-    builder["indentation"] = "  ";
-    std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
-    writer->write(json, &output);
+    auto start = std::chrono::steady_clock::now();
+
+    // the binary formats contain the same data, just encoded differently
+    switch (format(output))
+    {
+        case YSerializerFormat::cbor:
+            YBinaryEncoder::cbor(json, output);
+            break;
+
+        case YSerializerFormat::msgpack:
+            YBinaryEncoder::msgpack(json, output);
+            break;
+
+        case YSerializerFormat::json:
+        {
+            // use a custom indentation, the default it too big,
+            // the dialogs usually have too many nested widgets
+            Json::StreamWriterBuilder builder;
+            builder["indentation"] = "  ";
+            std::unique_ptr<Json::StreamWriter> writer(builder.newStreamWriter());
+            writer->write(json, &output);
+            break;
+        }
+    }
+
+    add_time(output, start);
 }
 
-void YJsonSerializer::serialize(YWidget *w, std::ostream &output, bool recursive) {
+void YJsonSerializer::serialize(YWidget *w, std::ostream &output, bool recursive,
+    const YJsonItemsFilter &filter) {
     if (!w) return;
-    Json::Value json = serialize_rec(w, recursive);
+    auto start = std::chrono::steady_clock::now();
+    Json::Value json = serialize_rec(w, recursive, filter);
+    add_time(output, start);
     save(json, output);
 }
 
-void YJsonSerializer::serialize(const std::vector<YWidget*> &widgets, std::ostream &output, bool recursive) {
+void YJsonSerializer::serialize(const std::vector<YWidget*> &widgets, std::ostream &output, bool recursive,
+    const YJsonItemsFilter &filter) {
+    auto start = std::chrono::steady_clock::now();
     Json::Value array;
 
     for(YWidget *widget: widgets)
     {
-        Json::Value json = serialize_rec(widget, recursive);
+        Json::Value json = serialize_rec(widget, recursive, filter);
         array.append(json);
     }
 
+    add_time(output, start);
     save(array, output);
 }
 
@@ -167,7 +232,28 @@ void serialize_widget_data(YWidget *widget, Json::Value &json) {
 
 namespace
 {
-    void add_items_rec(Json::Value &jitem, const YItem *yitem)
+    // is the item or any of its children selected?
+    bool selected_rec(const YItem *yitem)
+    {
+        if (yitem->selected())
+            return true;
+
+        for (YItemConstIterator it = yitem->childrenBegin(); it != yitem->childrenEnd(); ++it)
+        {
+            if (selected_rec(*it))
+                return true;
+        }
+
+        return false;
+    }
+
+    // should be the item serialized?
+    bool filter_item(const YItem *yitem, const YJsonItemsFilter &filter)
+    {
+        return !filter.selected_only || selected_rec(yitem);
+    }
+
+    void add_items_rec(Json::Value &jitem, const YItem *yitem, const YJsonItemsFilter &filter, int depth = 1)
     {
         if (yitem->selected())
             jitem["selected"] = true;
@@ -178,12 +264,34 @@ namespace
             Json::Value icons, labels;
             // add icons only if not empty
             bool no_icon = true;
-            std::for_each(tabitem->cellsBegin(), tabitem->cellsEnd(), [&](const YTableCell *ycell)
+            auto add_cell = [&](const YTableCell *ycell)
             {
                 no_icon &= ycell->iconName().empty();
                 icons.append(ycell->iconName());
                 labels.append(ycell->label());
-            });
+            };
+
+            if (filter.columns.empty())
+            {
+                std::for_each(tabitem->cellsBegin(), tabitem->cellsEnd(), add_cell);
+            }
+            else
+            {
+                for (int column: filter.columns)
+                {
+                    // a missing cell is serialized as an empty one
+                    if (const YTableCell *ycell = tabitem->cell(column))
+                    {
+                        add_cell(ycell);
+                    }
+                    else
+                    {
+                        icons.append("");
+                        labels.append("");
+                    }
+                }
+            }
+
             if (!no_icon)
                 jitem["icons"] = icons;
 
@@ -204,13 +312,23 @@ namespace
         // this is mainly for the generic widgets like YSelectionBox, YComboBox,...
         if (yitem->hasChildren())
         {
-            Json::Value children;
+            // too deep, just report there are some children
+            if (filter.depth >= 0 && depth >= filter.depth)
+            {
+                jitem["children_count"] = (Json::Value::UInt64) std::distance(yitem->childrenBegin(), yitem->childrenEnd());
+                return;
+            }
+
+            Json::Value children(Json::arrayValue);
 
             // recursively add the children
             std::for_each(yitem->childrenBegin(), yitem->childrenEnd(), [&](const YItem *ychild)
             {
+                if (!filter_item(ychild, filter))
+                    return;
+
                 Json::Value child;
-                add_items_rec(child, ychild);
+                add_items_rec(child, ychild, filter, depth + 1);
                 children.append(child);
             });
 
@@ -219,7 +337,7 @@ namespace
     }
 }
 // widget specific data
-static void serialize_widget_specific_data(YWidget *widget, Json::Value &json) {
+static void serialize_widget_specific_data(YWidget *widget, Json::Value &json, const YJsonItemsFilter &filter) {
 
     // check all classes, some widgets might be derived from others
     // TODO: group the base classes and the final classes
@@ -357,13 +475,30 @@ static void serialize_widget_specific_data(YWidget *widget, Json::Value &json) {
         json["items_count"] = selection->itemsCount();
         json["icon_base_path"] = selection->iconBasePath();
 
-        Json::Value items;
-        std::for_each(selection->itemsBegin(), selection->itemsEnd(), [&](const YItem *yitem)
+        // slice the items here to avoid building the full item list for large tables
+        Json::Value items(Json::arrayValue);
+        int skip = filter.offset;
+        for (YItemConstIterator it = selection->itemsBegin(); it != selection->itemsEnd(); ++it)
         {
+            if (filter.limit >= 0 && items.size() >= (Json::ArrayIndex) filter.limit)
+                break;
+
+            if (!filter_item(*it, filter))
+                continue;
+
+            if (skip > 0)
+            {
+                --skip;
+                continue;
+            }
+
             Json::Value item;
-            add_items_rec(item, yitem);
+            add_items_rec(item, *it, filter);
             items.append(item);
-        });
+        }
+
+        if (filter.offset > 0)
+            json["items_offset"] = filter.offset;
 
         json["items"] = items;
     }
@@ -375,15 +510,23 @@ static void serialize_widget_specific_data(YWidget *widget, Json::Value &json) {
 
     if (auto tb = dynamic_cast<YTable*>(widget))
     {
+        // the serialized columns
+        std::vector<int> columns = filter.columns;
+        if ( columns.empty() )
+        {
+            for ( auto idx = 0; idx < tb->columns(); ++idx )
+                columns.push_back(idx);
+        }
+
         Json::Value header;
-        for ( auto idx = 0; idx < tb->columns(); ++idx )
+        for ( int idx: columns )
         {
             header.append(tb->header(idx));
         }
         json["header"] = header;
 
         Json::Value alignment;
-        for ( auto idx = 0; idx < tb->columns(); ++idx )
+        for ( int idx: columns )
         {
             std::string alignment_str;
             switch (tb->alignment(idx))
@@ -26,19 +26,56 @@ namespace Json {
     class Value;
 }
 
+// restrict the serialized items of the selection widgets (tables, trees,...),
+// the default values do not restrict anything
+struct YJsonItemsFilter
+{
+    // skip the first N top level items
+    int offset = 0;
+    // serialize at most N top level items, negative value means no limit
+    int limit = -1;
+    // serialize only the selected items (and the parents of the selected items)
+    bool selected_only = false;
+    // serialize only these table columns, empty means all columns
+    std::vector<int> columns;
+    // maximum depth of the nested items (1 = only the top level items),
+    // negative value means no limit
+    int depth = -1;
+};
+
+// the format written by YJsonSerializer::save()
+enum class YSerializerFormat
+{
+    json,
+    cbor,
+    msgpack
+};
+
 class YJsonSerializer
 {
 
 public:
 
     // serialize one widget (by default recursively with all children)
-    static void serialize(YWidget *, std::ostream &output, bool recursive = true);
+    static void serialize(YWidget *, std::ostream &output, bool recursive = true,
+        const YJsonItemsFilter &filter = YJsonItemsFilter());
 
     // serialize widget array (by default recursively with all children)
-    static void serialize(const std::vector<YWidget*> &widgets, std::ostream &output, bool recursive = true);
+    static void serialize(const std::vector<YWidget*> &widgets, std::ostream &output, bool recursive = true,
+        const YJsonItemsFilter &filter = YJsonItemsFilter());
 
-    // save the JSON value as a text into the output stream
+    // save the JSON value into the output stream, as a text or in a binary
+    // format depending on the format set for the stream
     static void save(const Json::Value &json, std::ostream &output);
+
+    // set the format used for the output stream (JSON text by default)
+    static void set_format(std::ostream &output, YSerializerFormat format);
+
+    // the format used for the output stream
+    static YSerializerFormat format(std::ostream &output);
+
+    // total time spent serializing into the output stream (in seconds)
+    static double serialization_time(std::ostream &output);
 };
 
 #endif // YJsonSerializer_h
@@ -25,6 +25,8 @@
 
 #include "YTableActionHandler.h"
 
+// the maximum number of the kept table indexes
+static const size_t max_label_indexes = 16;
 
 std::function<void (YTable*)> YTableActionHandler::get_handler( YTable * widget,
                                                                 const std::string &value,
@@ -54,13 +56,7 @@ std::function<void (YTable*)> YTableActionHandler::get_handler( YTable * widget,
 
     // Do the search of the value in the given column
     return [&] (YTable *tb) {
-        std::vector<std::string> path;
-        boost::split( path, value, boost::is_any_of( TablePathDelimiter ) );
-        auto * item = YTableActionHandler::table_findItem( path.begin(),
-                                                           path.end(),
-                                                           tb->itemsBegin(),
-                                                           tb->itemsEnd(),
-                                                           column_id );
+        auto * item = find_item( tb, value, column_id );
         if ( item )
         {
                 yuiMilestone() << "Activating Table \"" << tb->label() << "\" Item: \"" << item->label( column_id ) << "\"" << std::endl;
@@ -76,6 +72,107 @@ std::function<void (YTable*)> YTableActionHandler::get_handler( YTable * widget,
 }
 
 
+YTableItem *
+YTableActionHandler::find_item( YTable * table, const std::string &value, int column_id )
+{
+    std::vector<std::string> path;
+    boost::split( path, value, boost::is_any_of( TablePathDelimiter ) );
+
+    // the index is rebuilt when items are added or removed but changing
+    // a cell label is not tracked, so verify the found items
+    bool stale = false;
+
+    auto search = [&]( const LabelIndex & index ) -> YTableItem *
+    {
+        auto found = index.items.find( path.front() );
+
+        if ( found == index.items.end() )
+            return nullptr;
+
+        for ( YTableItem * item: found->second )
+        {
+            if ( item->label( column_id ) != path.front() )
+            {
+                stale = true;
+                continue;
+            }
+
+            if ( path.size() == 1 )
+                return item;
+
+            // Search the child items
+            YTableItem * result = YTableActionHandler::table_findItem( std::next( path.cbegin() ),
+                                                                       path.cend(),
+                                                                       item->childrenBegin(),
+                                                                       item->childrenEnd(),
+                                                                       column_id );
+            if ( result )
+                return result;
+        }
+
+        return nullptr;
+    };
+
+    YTableItem * item = search( label_index( table, column_id ) );
+
+    if ( item )
+        return item;
+
+    // a changed label was found: rebuild the index once
+    if ( stale )
+        return search( label_index( table, column_id, true ) );
+
+    // a label changed to this value is not in the index yet, but rebuilding
+    // it for every value which is not in the table would be more expensive
+    // than searching linearly
+    return YTableActionHandler::table_findItem( path.cbegin(),
+                                                path.cend(),
+                                                table->itemsBegin(),
+                                                table->itemsEnd(),
+                                                column_id );
+}
+
+
+const YTableActionHandler::LabelIndex &
+YTableActionHandler::label_index( YTable * table, int column_id, bool rebuild )
+{
+    auto key = std::make_pair( (const YTable *) table, column_id );
+    auto it = _label_indexes.find( key );
+
+    if ( it != _label_indexes.end() && !rebuild && it->second.generation == table->itemsGeneration() )
+        return it->second;
+
+    if ( it == _label_indexes.end() )
+    {
+        // forget the indexes of the tables which were possibly deleted meanwhile
+        if ( _label_indexes.size() >= max_label_indexes )
+            _label_indexes.clear();
+
+        it = _label_indexes.emplace( key, LabelIndex() ).first;
+    }
+
+    yuiDebug() << "Building the label index for column " << column_id
+        << " of table \"" << table->label() << '"' << std::endl;
+
+    LabelIndex & index = it->second;
+    index.items.clear();
+    index.generation = table->itemsGeneration();
+
+    for ( YItemConstIterator item_it = table->itemsBegin(); item_it != table->itemsEnd(); ++item_it )
+    {
+        YTableItem * item = dynamic_cast<YTableItem *>( *item_it );
+
+        // keep the same behavior as the linear search: stop at the first non-table item
+        if ( ! item )
+            break;
+
+        index.items[ item->label( column_id ) ].push_back( item );
+    }
+
+    return index;
+}
+
+
 YTableItem *
 YTableActionHandler::table_findItem( std::vector<std::string>::const_iterator path_begin,
                                      std::vector<std::string>::const_iterator path_end,
@@ -18,6 +18,11 @@
 #define YTableActionHandler_h
 
 #include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <yui/YTable.h>
 #include <yui/YTableItem.h>
@@ -43,11 +48,40 @@ public:
     virtual void activate_widget( YTable * widget, YItem * item ) {};
 
 protected:
+    /**
+     * Find the table item by the cell values in the given column, use "|"
+     * separated path for the nested items. The top level items are found
+     * via an index, the nested items are searched linearly.
+     **/
+    YTableItem * find_item( YTable * table, const std::string &value, int column_id );
+
     static YTableItem * table_findItem( std::vector<std::string>::const_iterator path_begin,
                                         std::vector<std::string>::const_iterator path_end,
                                         YItemConstIterator                       begin,
                                         YItemConstIterator                       end,
                                         const int                               &column_id );
+
+private:
+
+    /**
+     * Index of the top level table items by the cell labels in one column
+     **/
+    struct LabelIndex
+    {
+        // YSelectionWidget::itemsGeneration() when the index was built
+        unsigned long generation = 0;
+        // cell label => items with that label (in the table order)
+        std::unordered_map<std::string, std::vector<YTableItem *>> items;
+    };
+
+    /**
+     * Return the index for the table column, (re)build it when it is
+     * missing or outdated or when "rebuild" is set.
+     **/
+    const LabelIndex & label_index( YTable * table, int column_id, bool rebuild = false );
+
+    // (table, column) => index
+    std::map<std::pair<const YTable *, int>, LabelIndex> _label_indexes;
 };
 
 #endif // YTableActionHandler_h
@@ -22,6 +22,7 @@
 
 /-*/
 
+#include <algorithm>
 #include <deque>
 
 #define YUILogComponent "ui"
@@ -51,6 +52,9 @@ struct YLogViewPrivate
     int		maxLines;
 
     StringDeque logText;
+
+    std::function<void( const string &, const string & )> appendHandler;
+    string	droppedText;	// lines dropped by appendLines()
 };
 
 
@@ -160,6 +164,29 @@ YLogView::lastLine() const
 
 void
 YLogView::appendLines( const string & newText )
+{
+    int oldLines = lines();
+    int newLines = std::count( newText.begin(), newText.end(), '\n' );
+
+    if ( ! newText.empty() && *(newText.rbegin()) != '\n' )
+	newLines++;                             // the last line has no newline
+
+    priv->droppedText.clear();
+    addLines( newText );
+
+    int droppedLines = oldLines + newLines - lines();
+
+    if ( ! priv->appendHandler || droppedLines > oldLines ) // some new lines are gone already
+	updateDisplay();
+    else
+	priv->appendHandler( newText, priv->droppedText );
+
+    priv->droppedText.clear();
+}
+
+
+void
+YLogView::addLines( const string & newText )
 {
     string			text	= newText;
     string::size_type	from	= 0;
@@ -186,8 +213,6 @@ YLogView::appendLines( const string & newText )
         // Output the rest
         appendLine( text.substr( to, text.size() - to ) );
     }
-
-    updateDisplay();
 }
 
 
@@ -198,6 +223,9 @@ YLogView::appendLine( const string & line )
 
     if ( maxLines() > 0 && priv->logText.size() > (unsigned) maxLines() )
     {
+        if ( priv->appendHandler )
+            priv->droppedText += priv->logText.front();
+
         priv->logText.pop_front();
     }
 }
@@ -211,7 +239,9 @@ YLogView::setLogText(const string & text)
 
   // do not use clearText as it do render and cause segfault in qt (bnc#989155)
   priv->logText.clear();
-  appendLines(text);
+  addLines(text);
+  priv->droppedText.clear();
+  updateDisplay();
 }
 
 
@@ -236,6 +266,13 @@ YLogView::updateDisplay()
 }
 
 
+void
+YLogView::setAppendHandler( AppendHandler handler )
+{
+    priv->appendHandler = handler;
+}
+
+
 
 const YPropertySet &
 YLogView::propertySet()
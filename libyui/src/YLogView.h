@@ -25,6 +25,8 @@
 #ifndef YLogView_h
 #define YLogView_h
 
+#include <functional>
+
 #include "YWidget.h"
 
 class YLogViewPrivate;
@@ -198,6 +200,24 @@ protected:
      **/
     virtual void displayLogText( const std::string & text ) = 0;
 
+    /**
+     * Handler for text appended with appendLines(): 'newLines' is the text
+     * that was appended, 'droppedText' is the text of the log lines that
+     * were removed from the start of the log text because of maxLines().
+     **/
+    typedef std::function<void( const std::string & newLines,
+				const std::string & droppedText )> AppendHandler;
+
+    /**
+     * Set a handler that appendLines() calls instead of displayLogText(),
+     * so derived classes can update the display incrementally instead of
+     * displaying the whole log text again. If some of the appended lines
+     * were removed already because of maxLines(), displayLogText() is
+     * called as usual.
+     *
+     * This is not a virtual method to keep the ABI of this class.
+     **/
+    void setAppendHandler( AppendHandler handler );
 
 private:
 
@@ -206,6 +226,12 @@ private:
      **/
     void appendLine( const std::string & line );
 
+    /**
+     * Split 'text' into lines and append them to the log text without
+     * updating the display.
+     **/
+    void addLines( const std::string & text );
+
     /**
      * Trigger a re-display of the log text.
      **/
@@ -34,6 +34,11 @@
 using std::string;
 
 
+// Generation numbers are unique among all selection widgets, a new widget
+// created at the address of a deleted one never gets an old number.
+static unsigned long lastItemsGeneration = 0;
+
+
 struct YSelectionWidgetPrivate
 {
     YSelectionWidgetPrivate( const string & label,
@@ -43,6 +48,7 @@ struct YSelectionWidgetPrivate
 	, enforceSingleSelection( enforceSingleSelection )
         , enforceInitialSelection( true )
 	, recursiveSelection ( recursiveSelection )
+	, itemsGeneration( ++lastItemsGeneration )
 	{}
 
     string		label;
@@ -51,6 +57,7 @@ struct YSelectionWidgetPrivate
     bool		recursiveSelection;
     string		iconBasePath;
     YItemCollection	itemCollection;
+    unsigned long	itemsGeneration;
 };
 
 
@@ -93,6 +100,7 @@ void YSelectionWidget::deleteAllItems()
     }
 
     priv->itemCollection.clear();
+    priv->itemsGeneration = ++lastItemsGeneration;
 }
 
 
@@ -204,6 +212,7 @@ void YSelectionWidget::addItem( YItem * item )
 
     priv->itemCollection.push_back( item );
     item->setIndex( priv->itemCollection.size() - 1 );
+    priv->itemsGeneration = ++lastItemsGeneration;
 
     // yuiDebug() << "Adding item \"" << item->label() << "\"" << endl;
 
@@ -325,6 +334,12 @@ int YSelectionWidget::itemsCount() const
 }
 
 
+unsigned long YSelectionWidget::itemsGeneration() const
+{
+    return priv->itemsGeneration;
+}
+
+
 YItem *
 YSelectionWidget::firstItem() const
 {
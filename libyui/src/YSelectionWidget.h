@@ -162,6 +162,16 @@ public:
      **/
     int itemsCount() const;
 
+    /**
+     * Return a number identifying the current state of the item list.
+     * It changes every time items are added or removed and it is unique
+     * among all selection widgets, so it can be used to detect when data
+     * derived from the items (like a lookup index) need to be rebuilt.
+     *
+     * Changes of the items themselves (labels, children) are not tracked.
+     **/
+    unsigned long itemsGeneration() const;
+
     /**
      * Return the item at index 'index' (from 0)
      * or 0 if there is no such item.
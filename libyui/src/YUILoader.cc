@@ -44,7 +44,8 @@ using std::string;
 bool rest_enabled()
 {
     const char *env = getenv("YUI_HTTP_PORT");
-    return env && atoi(env) > 0;
+    const char *socket = getenv("YUI_HTTP_SOCKET");
+    return ( env && atoi(env) > 0 ) || ( socket && *socket );
 }
 
 
@@ -0,0 +1,146 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+// This is an unit test for appending lines to the YLogView class
+
+#define BOOST_TEST_MODULE YLogView_tests
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+
+#include "YLogView.h"
+
+using std::string;
+using std::vector;
+
+// decrease the log level to warnings
+struct LogWarnings {
+  // global initialization before running any test
+  void setup() {
+      boost::unit_test::unit_test_log.set_threshold_level( boost::unit_test::log_warnings );
+  }
+  // cleanup after all tests are finished
+  void teardown() { }
+};
+
+BOOST_TEST_GLOBAL_FIXTURE( LogWarnings );
+
+
+// A log view that records what it is asked to display
+class TestLogView : public YLogView
+{
+public:
+
+    TestLogView( int maxLines, bool incremental = true )
+        : YLogView( 0, "Log", 5, maxLines )
+    {
+        if ( incremental )
+            setAppendHandler( [this]( const string & newLines, const string & droppedText )
+                              {
+                                  appended.push_back( newLines );
+                                  dropped.push_back( droppedText );
+                              } );
+    }
+
+    virtual const char * widgetClass() const { return "TestLogView"; }
+    virtual int preferredWidth()  { return 10; }
+    virtual int preferredHeight() { return 5; }
+    virtual void setSize( int, int ) {}
+
+    vector<string> displayed;   // displayLogText() calls
+    vector<string> appended;    // append handler calls: the new lines
+    vector<string> dropped;     // append handler calls: the dropped text
+
+protected:
+
+    virtual void displayLogText( const string & text ) { displayed.push_back( text ); }
+};
+
+
+BOOST_AUTO_TEST_CASE( append_without_handler )
+{
+    // Widgets have to be created with operator new; they are not deleted
+    // since the YWidget destructor needs a UI
+    TestLogView * logView = new TestLogView( 0, false );
+    logView->appendLines( "a\nb\n" );
+
+    // the whole text is displayed again
+    BOOST_CHECK_EQUAL( logView->displayed.size(), 1 );
+    BOOST_CHECK_EQUAL( logView->displayed.back(), "a\nb" );
+    BOOST_CHECK_EQUAL( logView->lines(), 2 );
+}
+
+BOOST_AUTO_TEST_CASE( append_with_handler )
+{
+    TestLogView * logView = new TestLogView( 0 );
+    logView->appendLines( "a\nb\n" );
+    logView->appendLines( "c\n" );
+
+    // only the new lines are passed to the handler, nothing is dropped
+    BOOST_CHECK( logView->displayed.empty() );
+    BOOST_CHECK_EQUAL( logView->appended.size(), 2 );
+    BOOST_CHECK_EQUAL( logView->appended[0], "a\nb\n" );
+    BOOST_CHECK_EQUAL( logView->appended[1], "c\n" );
+    BOOST_CHECK_EQUAL( logView->dropped[0], "" );
+    BOOST_CHECK_EQUAL( logView->dropped[1], "" );
+    BOOST_CHECK_EQUAL( logView->logText(), "a\nb\nc" );
+}
+
+BOOST_AUTO_TEST_CASE( max_lines_rollover )
+{
+    TestLogView * logView = new TestLogView( 3 );
+    logView->appendLines( "1\n2\n3\n" );
+    logView->appendLines( "4\n5\n" );
+
+    // the oldest lines are dropped and passed to the handler
+    BOOST_CHECK_EQUAL( logView->appended.size(), 2 );
+    BOOST_CHECK_EQUAL( logView->dropped[0], "" );
+    BOOST_CHECK_EQUAL( logView->appended[1], "4\n5\n" );
+    BOOST_CHECK_EQUAL( logView->dropped[1], "1\n2\n" );
+    BOOST_CHECK_EQUAL( logView->lines(), 3 );
+    BOOST_CHECK_EQUAL( logView->logText(), "3\n4\n5" );
+}
+
+BOOST_AUTO_TEST_CASE( append_without_newline )
+{
+    TestLogView * logView = new TestLogView( 2 );
+    logView->appendLines( "a\n" );
+    logView->appendLines( "b" );
+    logView->appendLines( "c\n" );
+
+    // an append without a trailing newline is a log line of its own
+    BOOST_CHECK_EQUAL( logView->lines(), 2 );
+    BOOST_CHECK_EQUAL( logView->dropped[2], "a\n" );
+
+    logView->appendLines( "d\n" );
+
+    BOOST_CHECK_EQUAL( logView->dropped[3], "b" );
+    BOOST_CHECK_EQUAL( logView->logText(), "c\nd" );
+    BOOST_CHECK( logView->displayed.empty() );
+}
+
+BOOST_AUTO_TEST_CASE( new_lines_dropped )
+{
+    TestLogView * logView = new TestLogView( 2 );
+    logView->appendLines( "a\n" );
+    logView->appendLines( "b\nc\nd\n" );
+
+    // some of the new lines are gone already: the whole text is displayed
+    BOOST_CHECK_EQUAL( logView->appended.size(), 1 );
+    BOOST_CHECK_EQUAL( logView->displayed.size(), 1 );
+    BOOST_CHECK_EQUAL( logView->displayed.back(), "c\nd" );
+}
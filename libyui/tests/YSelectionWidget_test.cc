@@ -0,0 +1,97 @@
+/*
+  Copyright (C) 2021 SUSE LLC
+
+  This library is free software; you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation; either version 2.1 of the
+  License, or (at your option) version 3.0 of the License. This library
+  is distributed in the hope that it will be useful, but WITHOUT ANY
+  WARRANTY; without even the implied warranty of MERCHANTABILITY or
+  FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+  License for more details. You should have received a copy of the GNU
+  Lesser General Public License along with this library; if not, write
+  to the Free Software Foundation, Inc., 51 Franklin Street, Fifth
+  Floor, Boston, MA 02110-1301 USA
+*/
+
+// This is an unit test for the items generation of the YSelectionWidget class
+
+#define BOOST_TEST_MODULE YSelectionWidget_tests
+#include <boost/test/unit_test.hpp>
+
+#include "YSelectionWidget.h"
+#include "YItem.h"
+
+// decrease the log level to warnings
+struct LogWarnings {
+  // global initialization before running any test
+  void setup() {
+      boost::unit_test::unit_test_log.set_threshold_level( boost::unit_test::log_warnings );
+  }
+  // cleanup after all tests are finished
+  void teardown() { }
+};
+
+BOOST_TEST_GLOBAL_FIXTURE( LogWarnings );
+
+
+class TestSelectionWidget : public YSelectionWidget
+{
+public:
+
+    TestSelectionWidget()
+        : YSelectionWidget( 0, "Test", true )
+        {}
+
+    virtual const char * widgetClass() const { return "TestSelectionWidget"; }
+    virtual int preferredWidth()  { return 10; }
+    virtual int preferredHeight() { return 5; }
+    virtual void setSize( int, int ) {}
+};
+
+
+// Widgets have to be created with operator new; they are not deleted since
+// the YWidget destructor needs a UI
+
+BOOST_AUTO_TEST_CASE( generation_add_item )
+{
+    TestSelectionWidget * widget = new TestSelectionWidget();
+    unsigned long generation = widget->itemsGeneration();
+
+    widget->addItem( new YItem( "a" ) );
+    BOOST_CHECK_NE( widget->itemsGeneration(), generation );
+
+    generation = widget->itemsGeneration();
+    widget->addItem( new YItem( "b" ) );
+    BOOST_CHECK_NE( widget->itemsGeneration(), generation );
+}
+
+BOOST_AUTO_TEST_CASE( generation_delete_all_items )
+{
+    TestSelectionWidget * widget = new TestSelectionWidget();
+    widget->addItem( new YItem( "a" ) );
+    unsigned long generation = widget->itemsGeneration();
+
+    widget->deleteAllItems();
+    BOOST_CHECK_NE( widget->itemsGeneration(), generation );
+}
+
+BOOST_AUTO_TEST_CASE( generation_unchanged )
+{
+    TestSelectionWidget * widget = new TestSelectionWidget();
+    widget->addItem( new YItem( "a" ) );
+    unsigned long generation = widget->itemsGeneration();
+
+    // selecting an item does not change the items
+    widget->selectItem( widget->itemAt( 0 ) );
+    BOOST_CHECK_EQUAL( widget->itemsGeneration(), generation );
+}
+
+BOOST_AUTO_TEST_CASE( generation_unique )
+{
+    // a new widget never has the generation of another one, so a cache
+    // for a deleted widget can't be taken for a new one at the same address
+    TestSelectionWidget * widget1 = new TestSelectionWidget();
+    TestSelectionWidget * widget2 = new TestSelectionWidget();
+    BOOST_CHECK_NE( widget1->itemsGeneration(), widget2->itemsGeneration() );
+}